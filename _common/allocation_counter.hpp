@@ -0,0 +1,11 @@
+#ifndef ALLOCATION_COUNTER_HPP
+#define ALLOCATION_COUNTER_HPP
+
+#include <atomic>
+#include <cstddef>
+
+// number of allocations in the process - counted by the global operator new replaced in allocation_counter.cpp,
+// so the program must link that file (add it to the sources of the executable)
+extern std::atomic<size_t> allocations_count;
+
+#endif // ALLOCATION_COUNTER_HPP
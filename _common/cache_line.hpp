@@ -0,0 +1,14 @@
+#ifndef CACHE_LINE_HPP
+#define CACHE_LINE_HPP
+
+#include <cstddef>
+
+namespace Hardware
+{
+    // Size of a cache line used in alignas() against false sharing.
+    // std::hardware_destructive_interference_size changes with -mtune/-mcpu, so in a header it would
+    // change the layout of the class between translation units built with different flags (gcc: -Winterference-size).
+    inline constexpr std::size_t cache_line_size = 64;
+}
+
+#endif // CACHE_LINE_HPP
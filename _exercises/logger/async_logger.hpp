@@ -0,0 +1,900 @@
+#ifndef ASYNC_LOGGER_HPP
+#define ASYNC_LOGGER_HPP
+
+#include "binary_log.hpp"
+#include "cache_line.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <format>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <stdexcept>
+#include <stop_token>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace After
+{
+    namespace Details
+    {
+        // SPSC ring of length-prefixed records - the producer is one logging thread, the consumer the writer thread
+        // - a record never wraps: when it does not fit before the end, a wrap marker sends the consumer to the start
+        class RecordRing
+        {
+            static constexpr size_t header_size = 8; // record size + padding - keeps payloads 8-byte aligned
+            static constexpr std::uint32_t wrap_marker = 0xFFFFFFFF;
+
+            const size_t capacity_;
+            const size_t mask_;
+            const std::unique_ptr<std::byte[]> buffer_;
+            const std::uint32_t thread_id_; // producer
+
+            alignas(Hardware::cache_line_size) std::atomic<std::uint64_t> tail_{0}; // published by the producer
+            std::uint64_t write_pos_ = 0;                                        // producer only
+            std::uint64_t cached_head_ = 0;                                      // producer only
+
+            alignas(Hardware::cache_line_size) std::atomic<std::uint64_t> head_{0}; // released by the consumer
+            std::atomic<bool> is_orphaned_{false}; // owner thread has exited
+
+            static size_t record_size(size_t payload_size)
+            {
+                return (header_size + payload_size + 7) & ~size_t{7};
+            }
+
+        public:
+            RecordRing(size_t capacity, std::uint32_t thread_id)
+                : capacity_{std::bit_ceil(capacity)}
+                , mask_{capacity_ - 1}
+                , buffer_{std::make_unique<std::byte[]>(capacity_)}
+                , thread_id_{thread_id}
+            {
+            }
+
+            std::uint32_t thread_id() const
+            {
+                return thread_id_;
+            }
+
+            size_t max_payload_size() const
+            {
+                return capacity_ / 2 - header_size;
+            }
+
+            // pointer to size bytes for the payload or nullptr when the ring is full - publish it with commit()
+            std::byte* try_reserve(size_t size)
+            {
+                const size_t bytes = record_size(size);
+                const size_t pos = write_pos_ & mask_;
+                const size_t till_end = capacity_ - pos;
+                const size_t needed = bytes <= till_end ? bytes : till_end + bytes;
+
+                if (write_pos_ + needed - cached_head_ > capacity_)
+                {
+                    cached_head_ = head_.load(std::memory_order_acquire);
+                    if (write_pos_ + needed - cached_head_ > capacity_)
+                        return nullptr;
+                }
+
+                if (bytes > till_end)
+                {
+                    std::memcpy(&buffer_[pos], &wrap_marker, sizeof(wrap_marker));
+                    write_pos_ += till_end;
+                }
+
+                std::byte* record = &buffer_[write_pos_ & mask_];
+                const auto payload_size = static_cast<std::uint32_t>(size);
+                std::memcpy(record, &payload_size, sizeof(payload_size));
+                write_pos_ += bytes;
+
+                return record + header_size;
+            }
+
+            void commit()
+            {
+                tail_.store(write_pos_, std::memory_order_release);
+            }
+
+            // consumer - calls on_record(payload) for every committed record
+            template <typename TOnRecord>
+            size_t drain(TOnRecord&& on_record)
+            {
+                std::uint64_t head = head_.load(std::memory_order_relaxed);
+                const std::uint64_t tail = tail_.load(std::memory_order_acquire);
+
+                size_t count = 0;
+                while (head != tail)
+                {
+                    const size_t pos = head & mask_;
+
+                    std::uint32_t size;
+                    std::memcpy(&size, &buffer_[pos], sizeof(size));
+                    if (size == wrap_marker)
+                    {
+                        head += capacity_ - pos;
+                        continue;
+                    }
+
+                    on_record(std::span<const std::byte>{&buffer_[pos + header_size], size});
+                    head += record_size(size);
+                    ++count;
+                }
+
+                head_.store(head, std::memory_order_release);
+                return count;
+            }
+
+            void orphan()
+            {
+                is_orphaned_.store(true, std::memory_order_release);
+            }
+
+            bool is_orphaned() const
+            {
+                return is_orphaned_.load(std::memory_order_acquire);
+            }
+        };
+
+        // arguments are stored in the record as they are passed - strings as size + characters, other values as raw bytes
+        template <typename T>
+        concept LogString = std::is_convertible_v<const T&, std::string_view>;
+
+        // values that stay meaningful when copied bytewise and formatted later on the writer thread -
+        // pointers other than void* would be formatted long after the pointee may be gone
+        template <typename T>
+        concept LogArgument = LogString<T> || std::is_arithmetic_v<T> || std::is_enum_v<T> || std::is_same_v<T, void*>
+            || std::is_same_v<T, const void*> || std::is_null_pointer_v<T>;
+
+        template <typename T>
+        using Decoded = std::conditional_t<LogString<T>, std::string_view, T>;
+
+        // a null C-string is logged as (null) - string_view{nullptr} is undefined behaviour
+        template <LogString T>
+        std::string_view as_string_view(const T& text)
+        {
+            if constexpr (std::is_pointer_v<T>)
+            {
+                if (text == nullptr)
+                    return "(null)";
+            }
+            return text;
+        }
+
+        template <LogArgument T>
+        size_t encoded_size(const T& arg)
+        {
+            if constexpr (LogString<T>)
+                return sizeof(std::uint32_t) + as_string_view(arg).size();
+            else
+                return sizeof(T);
+        }
+
+        template <LogArgument T>
+        std::byte* encode(std::byte* out, const T& arg)
+        {
+            if constexpr (LogString<T>)
+            {
+                const std::string_view text = as_string_view(arg);
+                const auto size = static_cast<std::uint32_t>(text.size());
+                std::memcpy(out, &size, sizeof(size));
+                std::memcpy(out + sizeof(size), text.data(), text.size());
+                return out + sizeof(size) + text.size();
+            }
+            else
+            {
+                std::memcpy(out, &arg, sizeof(T));
+                return out + sizeof(T);
+            }
+        }
+
+        template <LogArgument T>
+        Decoded<T> decode(const std::byte*& in)
+        {
+            if constexpr (LogString<T>)
+            {
+                std::uint32_t size;
+                std::memcpy(&size, in, sizeof(size));
+                const std::string_view text{reinterpret_cast<const char*>(in + sizeof(size)), size};
+                in += sizeof(size) + size;
+                return text;
+            }
+            else
+            {
+                std::array<std::byte, sizeof(T)> raw;
+                std::memcpy(raw.data(), in, sizeof(T));
+                in += sizeof(T);
+                return std::bit_cast<T>(raw);
+            }
+        }
+
+        template <LogArgument T>
+        constexpr BinaryLog::ArgInfo arg_info()
+        {
+            using BinaryLog::ArgType;
+
+            if constexpr (LogString<T>)
+                return {ArgType::string, 0};
+            else if constexpr (std::is_same_v<T, bool>)
+                return {ArgType::boolean, sizeof(T)};
+            else if constexpr (std::is_same_v<T, char>)
+                return {ArgType::character, sizeof(T)};
+            else if constexpr (std::is_integral_v<T> && sizeof(T) <= sizeof(std::uint64_t))
+                return {std::is_signed_v<T> ? ArgType::signed_integer : ArgType::unsigned_integer, sizeof(T)};
+            else if constexpr (std::is_enum_v<T>)
+                return arg_info<std::underlying_type_t<T>>(); // the decoder has no formatter of the enum
+            else if constexpr (std::is_floating_point_v<T>)
+                return {ArgType::floating_point, sizeof(T)};
+            else if constexpr (std::is_pointer_v<T> || std::is_null_pointer_v<T>)
+                return {ArgType::pointer, sizeof(T)};
+            else
+                return {ArgType::bytes, sizeof(T)};
+        }
+
+        // renders the arguments packed by Logger::log(fmt, args...) - runs on the writer thread
+        template <typename... TArgs>
+        void format_record(std::string& out, std::string_view fmt, const std::byte* args)
+        {
+            const std::tuple<Decoded<TArgs>...> values{decode<TArgs>(args)...}; // braced init - decoded left to right
+            std::apply([&](const auto&... values) { std::vformat_to(std::back_inserter(out), fmt, std::make_format_args(values...)); }, values);
+        }
+
+        // everything known about the arguments of a record - one static instance per argument types
+        struct RecordType
+        {
+            void (*format)(std::string& out, std::string_view fmt, const std::byte* args);
+            std::span<const BinaryLog::ArgInfo> args;
+        };
+
+        template <typename... TArgs>
+        inline constexpr std::array<BinaryLog::ArgInfo, sizeof...(TArgs)> arg_infos{arg_info<TArgs>()...};
+
+        template <typename... TArgs>
+        inline constexpr RecordType record_type{&format_record<TArgs...>, arg_infos<TArgs...>};
+
+        // start of every record - followed by the packed arguments
+        struct RecordHeader
+        {
+            const RecordType* type;
+            const char* fmt; // format strings are compile-time constants - never copied
+            size_t fmt_size;
+            std::chrono::system_clock::time_point time;
+        };
+
+        // 1, 2, ... in the order threads log for the first time
+        inline std::uint32_t this_thread_number()
+        {
+            static std::atomic<std::uint32_t> counter{0};
+            thread_local const std::uint32_t number = ++counter;
+            return number;
+        }
+
+        // 1, 2, ... shared by loggers of all sink types - they key the rings of a thread
+        inline std::uint64_t next_logger_id()
+        {
+            static std::atomic<std::uint64_t> counter{0};
+            return ++counter;
+        }
+
+        // rings of this thread - marked as orphaned when the thread exits, so the writer can drop them
+        class ThreadRings
+        {
+            struct Entry
+            {
+                std::uint64_t logger_id;
+                std::shared_ptr<RecordRing> ring;
+            };
+
+            std::vector<Entry> rings_; // one per logger this thread logs to - a handful, searched linearly
+
+        public:
+            ~ThreadRings()
+            {
+                for (auto& entry : rings_)
+                    entry.ring->orphan();
+            }
+
+            static ThreadRings& this_thread()
+            {
+                thread_local ThreadRings rings;
+                return rings;
+            }
+
+            RecordRing* find(std::uint64_t logger_id) const
+            {
+                for (const auto& entry : rings_)
+                    if (entry.logger_id == logger_id)
+                        return entry.ring.get();
+                return nullptr;
+            }
+
+            void add(std::uint64_t logger_id, std::shared_ptr<RecordRing> ring)
+            {
+                std::erase_if(rings_, [](const auto& entry) { return entry.ring.use_count() == 1; }); // rings of destroyed loggers
+                rings_.push_back({logger_id, std::move(ring)});
+            }
+        };
+    }
+
+    // record as the writer thread hands it to the sink
+    struct LogRecord
+    {
+        const Details::RecordType* type; // argument types & their formatter
+        std::string_view fmt;
+        std::chrono::system_clock::time_point time;
+        std::uint32_t thread_id;         // 1, 2, ... in the order threads log for the first time
+        std::span<const std::byte> args; // packed as described in binary_log.hpp
+
+        void format_to(std::string& out) const
+        {
+            type->format(out, fmt, args.data());
+        }
+    };
+
+    // text file written with large write() calls - no user-space buffering
+    class FileSink
+    {
+        int fd_;
+
+    public:
+        explicit FileSink(const std::string& file_name)
+            : fd_{::open(file_name.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644)}
+        {
+            if (fd_ < 0)
+                throw std::system_error(errno, std::generic_category(), "Cannot open " + file_name);
+        }
+
+        FileSink(FileSink&& other) noexcept
+            : fd_{std::exchange(other.fd_, -1)}
+        {
+        }
+
+        FileSink& operator=(FileSink&&) = delete;
+
+        ~FileSink()
+        {
+            if (fd_ >= 0)
+                ::close(fd_);
+        }
+
+        // one line per record
+        void append(std::string& batch, const LogRecord& record)
+        {
+            record.format_to(batch);
+            batch.push_back('\n');
+        }
+
+        void write(std::string_view data)
+        {
+            while (!data.empty())
+            {
+                const auto written = ::write(fd_, data.data(), data.size());
+                if (written < 0)
+                {
+                    if (errno == EINTR)
+                        continue;
+                    throw std::system_error(errno, std::generic_category(), "Log write failed");
+                }
+                data.remove_prefix(static_cast<size_t>(written));
+            }
+        }
+
+        void flush()
+        {
+        }
+    };
+
+    // compact binary log - turned back into text by decoder/log_decoder (layout in binary_log.hpp)
+    // - a format string with its argument types is written once, records refer to it by id
+    // - records hold varint encoded time deltas & integers - nothing is formatted
+    class BinaryFileSink
+    {
+        struct FormatKey
+        {
+            const Details::RecordType* type;
+            const char* fmt;
+            size_t fmt_size;
+
+            bool operator==(const FormatKey&) const = default;
+        };
+
+        struct FormatKeyHash
+        {
+            size_t operator()(const FormatKey& key) const
+            {
+                return std::hash<const void*>{}(key.type) * 31 ^ std::hash<const void*>{}(key.fmt) ^ key.fmt_size;
+            }
+        };
+
+        FileSink file_;
+        std::unordered_map<FormatKey, std::uint64_t, FormatKeyHash> format_ids_; // writer thread only
+        std::int64_t last_time_ = 0;
+
+    public:
+        explicit BinaryFileSink(const std::string& file_name)
+            : file_{file_name}
+        {
+            std::string header{BinaryLog::magic, sizeof(BinaryLog::magic)};
+            header.append(reinterpret_cast<const char*>(&BinaryLog::version), sizeof(BinaryLog::version));
+            file_.write(header);
+        }
+
+        void append(std::string& batch, const LogRecord& record)
+        {
+            const auto [it, is_new] = format_ids_.try_emplace(FormatKey{record.type, record.fmt.data(), record.fmt.size()}, format_ids_.size() + 1);
+            if (is_new)
+                append_definition(batch, record);
+
+            // records of different threads are not in time order - the delta may be negative
+            const std::int64_t time = std::chrono::duration_cast<std::chrono::nanoseconds>(record.time.time_since_epoch()).count();
+            BinaryLog::append_varint(batch, it->second);
+            BinaryLog::append_varint(batch, BinaryLog::zigzag(time - last_time_));
+            BinaryLog::append_varint(batch, record.thread_id);
+            last_time_ = time;
+
+            const std::byte* in = record.args.data();
+            for (const auto& arg : record.type->args)
+                in = append_arg(batch, arg, in);
+        }
+
+        void write(std::string_view data)
+        {
+            file_.write(data);
+        }
+
+        void flush()
+        {
+            file_.flush();
+        }
+
+    private:
+        static void append_definition(std::string& batch, const LogRecord& record)
+        {
+            BinaryLog::append_varint(batch, BinaryLog::format_definition);
+            BinaryLog::append_varint(batch, record.fmt.size());
+            batch.append(record.fmt);
+            BinaryLog::append_varint(batch, record.type->args.size());
+            for (const auto& arg : record.type->args)
+            {
+                batch.push_back(static_cast<char>(arg.type));
+                BinaryLog::append_varint(batch, arg.size);
+            }
+        }
+
+        // re-encodes one argument packed by Logger::log - returns the start of the next one
+        static const std::byte* append_arg(std::string& batch, const BinaryLog::ArgInfo& arg, const std::byte* in)
+        {
+            using BinaryLog::ArgType;
+
+            switch (arg.type)
+            {
+            case ArgType::signed_integer:
+            case ArgType::unsigned_integer:
+            case ArgType::pointer:
+            {
+                static_assert(std::endian::native == std::endian::little, "integers are widened by copying their low bytes");
+
+                std::uint64_t bits = 0;
+                std::memcpy(&bits, in, arg.size);
+                if (arg.type == ArgType::signed_integer)
+                {
+                    const int unused = 64 - 8 * static_cast<int>(arg.size);
+                    bits = BinaryLog::zigzag(static_cast<std::int64_t>(bits << unused) >> unused); // sign extension
+                }
+                BinaryLog::append_varint(batch, bits);
+                return in + arg.size;
+            }
+            case ArgType::string:
+            {
+                std::uint32_t size;
+                std::memcpy(&size, in, sizeof(size));
+                BinaryLog::append_varint(batch, size);
+                batch.append(reinterpret_cast<const char*>(in + sizeof(size)), size);
+                return in + sizeof(size) + size;
+            }
+            default:
+                batch.append(reinterpret_cast<const char*>(in), arg.size);
+                return in + arg.size;
+            }
+        }
+    };
+
+    // text log written through mmap-ed, preallocated segments file_name.0, file_name.1, ...
+    // - write() is thread-safe: a writer reserves its bytes with fetch_add on the segment cursor and copies them
+    //   into the mapping - no lock, no syscall; only the write that overflows a segment rotates to the next one
+    // - a single write is never split across segments, so it may not exceed segment_size (keep it above the Logger's flush_size)
+    // - with max_segments > 0 only the newest segments are kept
+    // - crash safety: bytes copied into the mapping are in the page cache, so they survive a crash of the process
+    //   (a record being copied at that moment may be cut short, the rest of the segment reads as zero bytes);
+    //   after a kernel crash or power loss only rotated out segments (synced before they are unmapped)
+    //   and what was written back by the kernel or by flush() survive
+    class MappedFileSink
+    {
+        struct Segment
+        {
+            int fd = -1;
+            std::byte* data = nullptr;
+            alignas(Hardware::cache_line_size) std::atomic<size_t> cursor{0}; // reserved bytes
+            std::atomic<size_t> end{0}; // start of the first write that did not fit
+            std::atomic<size_t> writers{0}; // copying into data right now
+        };
+
+        std::string file_name_;
+        size_t segment_size_;
+        size_t max_segments_;
+        size_t next_index_ = 0;
+
+        // the current segment and a spare one, reused on every rotation - a writer may still hold a pointer to either,
+        // so they are never freed while the sink lives (a stale writer backs off as the segment is not current)
+        std::unique_ptr<Segment[]> segments_ = std::make_unique<Segment[]>(2);
+        std::atomic<Segment*> current_{nullptr};
+        std::mutex mtx_rotate_;
+
+    public:
+        explicit MappedFileSink(std::string file_name, size_t segment_size = 64 * 1024 * 1024, size_t max_segments = 0)
+            : file_name_{std::move(file_name)}
+            , segment_size_{segment_size}
+            , max_segments_{max_segments}
+        {
+            open_segment(segments_[0]);
+            current_ = &segments_[0];
+        }
+
+        MappedFileSink(MappedFileSink&& other) noexcept // only while nobody writes to other
+            : file_name_{std::move(other.file_name_)}
+            , segment_size_{other.segment_size_}
+            , max_segments_{other.max_segments_}
+            , next_index_{other.next_index_}
+            , segments_{std::move(other.segments_)}
+            , current_{other.current_.exchange(nullptr)}
+        {
+        }
+
+        MappedFileSink& operator=(MappedFileSink&&) = delete;
+
+        ~MappedFileSink()
+        {
+            if (Segment* segment = current_.load())
+                close_segment(*segment);
+        }
+
+        // one line per record
+        void append(std::string& batch, const LogRecord& record)
+        {
+            record.format_to(batch);
+            batch.push_back('\n');
+        }
+
+        void write(std::string_view data)
+        {
+            if (data.size() > segment_size_)
+                throw std::length_error("Log write larger than a segment");
+
+            while (true)
+            {
+                Segment* segment = current_.load();
+                segment->writers.fetch_add(1); // seq_cst pairs with the store of current_ in rotate()
+                if (segment != current_.load())
+                {
+                    segment->writers.fetch_sub(1); // rotated meanwhile - the segment may be unmapped or reopened
+                    continue;
+                }
+
+                const size_t pos = segment->cursor.fetch_add(data.size(), std::memory_order_relaxed);
+                if (pos + data.size() <= segment_size_)
+                {
+                    std::memcpy(segment->data + pos, data.data(), data.size());
+                    segment->writers.fetch_sub(1, std::memory_order_release);
+                    return;
+                }
+
+                size_t end = segment->end.load();
+                while (pos < end && !segment->end.compare_exchange_weak(end, pos))
+                    ;
+                segment->writers.fetch_sub(1, std::memory_order_release);
+
+                rotate(*segment);
+            }
+        }
+
+        // blocks until the written part of the current segment is on disk - writes copied concurrently may be included
+        void flush()
+        {
+            std::lock_guard lk{mtx_rotate_}; // the segment can't be unmapped meanwhile
+            sync_segment(*current_.load());
+        }
+
+    private:
+        std::string segment_name(size_t index) const
+        {
+            return file_name_ + "." + std::to_string(index);
+        }
+
+        size_t used_size(const Segment& segment) const
+        {
+            return std::min(segment.cursor.load(), segment.end.load());
+        }
+
+        // fills a free segment - published afterwards by storing it to current_
+        void open_segment(Segment& segment)
+        {
+            const std::string name = segment_name(next_index_);
+
+            const int fd = ::open(name.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+            if (fd < 0)
+                throw std::system_error(errno, std::generic_category(), "Cannot open " + name);
+
+            // allocated blocks - a full disk fails here instead of with SIGBUS on a store to the mapping
+            if (const int error = ::posix_fallocate(fd, 0, static_cast<off_t>(segment_size_)); error != 0)
+            {
+                ::close(fd);
+                throw std::system_error(error, std::generic_category(), "Cannot preallocate " + name);
+            }
+
+            void* data = ::mmap(nullptr, segment_size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            if (data == MAP_FAILED)
+            {
+                const int error = errno;
+                ::close(fd);
+                throw std::system_error(error, std::generic_category(), "Cannot map " + name);
+            }
+
+            segment.fd = fd;
+            segment.data = static_cast<std::byte*>(data);
+            segment.cursor.store(0, std::memory_order_relaxed);
+            segment.end.store(segment_size_, std::memory_order_relaxed);
+
+            if (max_segments_ > 0 && next_index_ >= max_segments_)
+            {
+                std::error_code ec; // best effort
+                std::filesystem::remove(segment_name(next_index_ - max_segments_), ec);
+            }
+
+            ++next_index_;
+        }
+
+        void rotate(Segment& full)
+        {
+            std::lock_guard lk{mtx_rotate_};
+            if (current_.load() != &full)
+                return; // rotated by another writer
+
+            Segment& next = &full == &segments_[0] ? segments_[1] : segments_[0]; // closed by the previous rotation
+            open_segment(next);
+            current_.store(&next);
+
+            close_segment(full);
+        }
+
+        void sync_segment(const Segment& segment)
+        {
+            if (::msync(segment.data, used_size(segment), MS_SYNC) != 0)
+                throw std::system_error(errno, std::generic_category(), "Log msync failed");
+        }
+
+        // waits for writers still copying into the segment - new ones back off as it is not current anymore
+        void close_segment(Segment& segment)
+        {
+            while (segment.writers.load(std::memory_order_acquire) != 0)
+                std::this_thread::yield();
+
+            ::msync(segment.data, used_size(segment), MS_SYNC); // best effort - also called from the destructor
+            ::munmap(segment.data, segment_size_);
+            segment.data = nullptr;
+            (void)::ftruncate(segment.fd, static_cast<off_t>(used_size(segment))); // drops unused preallocated bytes
+            ::close(segment.fd);
+            segment.fd = -1;
+        }
+    };
+
+    // Asynchronous logger:
+    // - log() copies the message into a lock-free ring of the calling thread - no lock, no syscall
+    // - log(fmt, args...) copies only the arguments - std::format runs on the writer thread, so the caller never allocates
+    // - one writer jthread drains all rings every flush_interval (or when a ring fills up)
+    //   and hands batches of at least flush_size bytes to the sink
+    // - a full ring makes log() wait for the writer - no record is ever dropped
+    // - the destructor drains every ring before the sink is closed; no thread may log concurrently with it
+    // - TSink renders records into the batch (append) and stores batches (write, flush) - FileSink, BinaryFileSink or MappedFileSink
+    template <typename TSink = FileSink>
+    class Logger
+    {
+        const std::uint64_t id_ = Details::next_logger_id(); // unique - never reused by another logger
+        TSink sink_;
+        const std::chrono::milliseconds flush_interval_;
+        const size_t flush_size_;
+        const size_t ring_capacity_;
+
+        mutable std::mutex mtx_rings_;
+        std::vector<std::shared_ptr<Details::RecordRing>> rings_;
+
+        std::mutex mtx_writer_;
+        std::condition_variable_any cv_writer_;
+        bool is_writer_woken_ = false;
+
+        std::string batch_; // writer only
+        std::jthread writer_; // started last
+
+    public:
+        explicit Logger(TSink sink, std::chrono::milliseconds flush_interval = std::chrono::milliseconds{50},
+            size_t flush_size = 64 * 1024, size_t ring_capacity = 64 * 1024)
+            : sink_{std::move(sink)}
+            , flush_interval_{flush_interval}
+            , flush_size_{flush_size}
+            , ring_capacity_{ring_capacity}
+            , writer_{[this](std::stop_token stop_token) { run(stop_token); }}
+        {
+            batch_.reserve(2 * flush_size_);
+        }
+
+        Logger(const Logger&) = delete;
+        Logger& operator=(const Logger&) = delete;
+
+        ~Logger()
+        {
+            writer_.request_stop();
+            writer_.join(); // final drain happens in the writer
+        }
+
+        void log(std::string_view message)
+        {
+            log("{}", message);
+        }
+
+        // fmt is checked at compile time - string arguments are copied, so they may die right after the call
+        template <Details::LogArgument... TArgs>
+        void log(std::format_string<TArgs...> fmt, const TArgs&... args)
+        {
+            const Details::RecordHeader header{
+                &Details::record_type<TArgs...>, fmt.get().data(), fmt.get().size(), std::chrono::system_clock::now()};
+            const size_t size = sizeof(header) + (size_t{0} + ... + Details::encoded_size(args));
+
+            Details::RecordRing& ring = this_thread_ring();
+            std::byte* out = reserve(ring, size);
+            std::memcpy(out, &header, sizeof(header));
+            out += sizeof(header);
+            ((out = Details::encode(out, args)), ...);
+            ring.commit();
+        }
+
+        // rings registered by logging threads - one per thread
+        size_t ring_count() const
+        {
+            std::lock_guard lk{mtx_rings_};
+            return rings_.size();
+        }
+
+    private:
+        std::byte* reserve(Details::RecordRing& ring, size_t size)
+        {
+            if (size > ring.max_payload_size())
+                throw std::length_error("Log record too long");
+
+            std::byte* payload;
+            while ((payload = ring.try_reserve(size)) == nullptr)
+            {
+                wake_writer();
+                std::this_thread::yield();
+            }
+            return payload;
+        }
+
+        Details::RecordRing& this_thread_ring()
+        {
+            struct CachedRing
+            {
+                std::uint64_t logger_id = 0;
+                Details::RecordRing* ring = nullptr;
+            };
+            thread_local CachedRing cached; // fast path for threads that keep logging to the same logger
+
+            if (cached.logger_id != id_)
+            {
+                auto& thread_rings = Details::ThreadRings::this_thread();
+
+                Details::RecordRing* ring = thread_rings.find(id_); // a thread switching between loggers reuses its rings
+                if (!ring)
+                {
+                    auto new_ring = std::make_shared<Details::RecordRing>(ring_capacity_, Details::this_thread_number());
+                    {
+                        std::lock_guard lk{mtx_rings_};
+                        rings_.push_back(new_ring);
+                    }
+                    ring = new_ring.get();
+                    thread_rings.add(id_, std::move(new_ring));
+                }
+
+                cached = {id_, ring};
+            }
+
+            return *cached.ring;
+        }
+
+        void wake_writer()
+        {
+            {
+                std::lock_guard lk{mtx_writer_};
+                is_writer_woken_ = true;
+            }
+            cv_writer_.notify_one();
+        }
+
+        void run(std::stop_token stop_token)
+        {
+            while (!stop_token.stop_requested())
+            {
+                {
+                    std::unique_lock lk{mtx_writer_};
+                    cv_writer_.wait_for(lk, stop_token, flush_interval_, [this] { return is_writer_woken_; });
+                    is_writer_woken_ = false;
+                }
+
+                drain_rings();
+                write_batch();
+            }
+
+            drain_rings(); // nothing is lost on shutdown
+            write_batch();
+            sink_.flush();
+        }
+
+        void drain_rings()
+        {
+            std::vector<std::shared_ptr<Details::RecordRing>> rings;
+            {
+                std::lock_guard lk{mtx_rings_};
+                rings = rings_;
+            }
+
+            for (const auto& ring : rings)
+            {
+                const bool is_orphaned = ring->is_orphaned(); // checked before draining - no records follow it
+
+                ring->drain([this, thread_id = ring->thread_id()](std::span<const std::byte> payload) {
+                    Details::RecordHeader header;
+                    std::memcpy(&header, payload.data(), sizeof(header));
+                    sink_.append(batch_, LogRecord{header.type, {header.fmt, header.fmt_size}, header.time, thread_id, payload.subspan(sizeof(header))});
+                    if (batch_.size() >= flush_size_)
+                        write_batch();
+                });
+
+                if (is_orphaned)
+                {
+                    std::lock_guard lk{mtx_rings_};
+                    std::erase(rings_, ring);
+                }
+            }
+        }
+
+        void write_batch()
+        {
+            if (batch_.empty())
+                return;
+
+            sink_.write(batch_);
+            batch_.clear();
+        }
+    };
+} // namespace After
+
+#endif // ASYNC_LOGGER_HPP
@@ -0,0 +1,57 @@
+#ifndef BINARY_LOG_HPP
+#define BINARY_LOG_HPP
+
+#include <cstdint>
+#include <string>
+
+// Layout of files written by After::BinaryFileSink - decoded on a platform with the same float & pointer formats:
+//   file       := magic, u32 version, entry*
+//   entry      := definition | record
+//   definition := v 0, v fmt_size, fmt, v no_of_args, (u8 type, v size)*   - format ids are 1, 2, ... in order of definition
+//   record     := v format_id, z time delta (ns since the previous record, the first one since epoch), v thread_id, args
+//   args       := booleans, characters, floating points & bytes as size raw bytes,
+//                 integers & pointers as v (signed integers as z), strings as v size + characters
+// v - unsigned LEB128 varint, z - zigzag encoded varint; a format is defined before the first record using it
+namespace BinaryLog
+{
+    inline constexpr char magic[4] = {'B', 'L', 'O', 'G'};
+    inline constexpr std::uint32_t version = 1;
+    inline constexpr std::uint64_t format_definition = 0;
+
+    enum class ArgType : std::uint8_t
+    {
+        boolean,
+        character,
+        signed_integer,
+        unsigned_integer,
+        floating_point,
+        string,
+        pointer,
+        bytes // integers wider than 64 bits - decoded as hex
+    };
+
+    struct ArgInfo
+    {
+        ArgType type;
+        std::uint32_t size; // 0 for strings
+    };
+
+    inline std::uint64_t zigzag(std::int64_t value)
+    {
+        return (static_cast<std::uint64_t>(value) << 1) ^ static_cast<std::uint64_t>(value >> 63);
+    }
+
+    inline std::int64_t unzigzag(std::uint64_t value)
+    {
+        return static_cast<std::int64_t>(value >> 1) ^ -static_cast<std::int64_t>(value & 1);
+    }
+
+    inline void append_varint(std::string& out, std::uint64_t value)
+    {
+        for (; value >= 0x80; value >>= 7)
+            out.push_back(static_cast<char>(value | 0x80));
+        out.push_back(static_cast<char>(value));
+    }
+}
+
+#endif // BINARY_LOG_HPP
@@ -0,0 +1,225 @@
+#include "../binary_log.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <format>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <variant>
+#include <vector>
+
+using namespace std;
+
+// turns a log written by After::BinaryFileSink back into text:
+//   2026-10-16 12:00:00.123456789 [1] Log#1 - Event#0
+
+struct Bytes
+{
+    string data;
+};
+
+using Arg = variant<bool, char, int64_t, uint64_t, float, double, long double, string, const void*, Bytes>;
+
+struct Format
+{
+    string fmt;
+    vector<BinaryLog::ArgInfo> args;
+};
+
+template <typename T>
+bool read_raw(istream& in, T& value)
+{
+    return static_cast<bool>(in.read(reinterpret_cast<char*>(&value), sizeof(value)));
+}
+
+template <typename T>
+T read_value(istream& in)
+{
+    T value;
+    if (!read_raw(in, value))
+        throw runtime_error("Truncated log");
+    return value;
+}
+
+uint64_t read_varint(istream& in)
+{
+    uint64_t value = 0;
+    for (int shift = 0; shift < 64; shift += 7)
+    {
+        const auto byte = static_cast<uint8_t>(read_value<char>(in));
+        value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0)
+            return value;
+    }
+    throw runtime_error("Bad varint");
+}
+
+string read_string(istream& in, size_t size)
+{
+    string text(size, '\0');
+    if (!in.read(text.data(), static_cast<streamsize>(size)))
+        throw runtime_error("Truncated log");
+    return text;
+}
+
+Arg read_arg(istream& in, const BinaryLog::ArgInfo& info)
+{
+    using BinaryLog::ArgType;
+
+    switch (info.type)
+    {
+    case ArgType::boolean:
+        return read_value<bool>(in);
+    case ArgType::character:
+        return read_value<char>(in);
+    case ArgType::signed_integer:
+        return BinaryLog::unzigzag(read_varint(in));
+    case ArgType::unsigned_integer:
+        return read_varint(in);
+    case ArgType::floating_point:
+        if (info.size == sizeof(float))
+            return read_value<float>(in);
+        if (info.size == sizeof(double))
+            return read_value<double>(in);
+        return read_value<long double>(in);
+    case ArgType::string:
+        return read_string(in, read_varint(in));
+    case ArgType::pointer:
+        return reinterpret_cast<const void*>(static_cast<uintptr_t>(read_varint(in)));
+    case ArgType::bytes:
+        return Bytes{read_string(in, info.size)};
+    }
+    throw runtime_error("Unknown argument type");
+}
+
+void format_arg(string& out, const string& spec, const Arg& arg)
+{
+    visit([&](const auto& value) {
+        if constexpr (is_same_v<decay_t<decltype(value)>, Bytes>)
+        {
+            out += "0x";
+            for (auto it = value.data.rbegin(); it != value.data.rend(); ++it) // little endian
+                format_to(back_inserter(out), "{:02x}", static_cast<unsigned char>(*it));
+        }
+        else
+            vformat_to(back_inserter(out), spec, make_format_args(value));
+    }, arg);
+}
+
+// std::vformat needs the argument types at compile time - fields are formatted one at a time
+// (nested replacement fields like {:{}} are not supported)
+string format_record(string_view fmt, const vector<Arg>& args)
+{
+    string out;
+    size_t next_arg = 0;
+    for (size_t i = 0; i < fmt.size(); ++i)
+    {
+        const char c = fmt[i];
+        if ((c == '{' || c == '}') && i + 1 < fmt.size() && fmt[i + 1] == c)
+        {
+            out += c;
+            ++i;
+            continue;
+        }
+
+        if (c != '{')
+        {
+            out += c;
+            continue;
+        }
+
+        const size_t end = fmt.find('}', i);
+        if (end == string_view::npos)
+            throw runtime_error("Bad format string: " + string{fmt});
+
+        const string_view field = fmt.substr(i + 1, end - i - 1);
+        const size_t colon = field.find(':');
+        const string_view arg_id = field.substr(0, colon);
+        const size_t index = arg_id.empty() ? next_arg++ : stoul(string{arg_id});
+        const string spec = "{" + string{colon == string_view::npos ? string_view{} : field.substr(colon)} + "}";
+
+        format_arg(out, spec, args.at(index));
+        i = end;
+    }
+    return out;
+}
+
+void decode(istream& in, ostream& out)
+{
+    char magic[sizeof(BinaryLog::magic)];
+    if (!in.read(magic, sizeof(magic)) || memcmp(magic, BinaryLog::magic, sizeof(magic)) != 0)
+        throw runtime_error("Not a binary log");
+    if (read_value<uint32_t>(in) != BinaryLog::version)
+        throw runtime_error("Unsupported binary log version");
+
+    vector<Format> formats; // index = format id - 1
+    vector<Arg> args;
+    string line;
+    int64_t time_ns = 0;
+
+    while (in.peek() != istream::traits_type::eof())
+    {
+        const uint64_t format_id = read_varint(in);
+        if (format_id == BinaryLog::format_definition)
+        {
+            Format format{read_string(in, read_varint(in)), {}};
+            format.args.resize(read_varint(in));
+            for (auto& arg : format.args)
+            {
+                arg.type = read_value<BinaryLog::ArgType>(in);
+                arg.size = static_cast<uint32_t>(read_varint(in));
+            }
+            formats.push_back(move(format));
+            continue;
+        }
+
+        if (format_id > formats.size())
+            throw runtime_error("Undefined format id " + to_string(format_id));
+        const Format& format = formats[format_id - 1];
+
+        time_ns += BinaryLog::unzigzag(read_varint(in));
+        const chrono::sys_time<chrono::nanoseconds> time{chrono::nanoseconds{time_ns}};
+        const uint64_t thread_id = read_varint(in);
+
+        args.clear();
+        for (const auto& info : format.args)
+            args.push_back(read_arg(in, info));
+
+        line.clear();
+        format_to(back_inserter(line), "{:%F %T} [{}] ", time, thread_id);
+        line += format_record(format.fmt, args);
+        out << line << '\n';
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc != 2)
+    {
+        cerr << "Usage: " << argv[0] << " <binary log>\n";
+        return 1;
+    }
+
+    ifstream in{argv[1], ios::binary};
+    if (!in)
+    {
+        cerr << "Cannot open " << argv[1] << "\n";
+        return 1;
+    }
+
+    try
+    {
+        decode(in, cout);
+    }
+    catch (const exception& e)
+    {
+        cout.flush();
+        cerr << argv[1] << ": " << e.what() << "\n";
+        return 1;
+    }
+}
@@ -1,7 +1,12 @@
+#include "async_logger.hpp"
+
 #include <chrono>
+#include <filesystem>
 #include <fstream>
+#include <format>
 #include <functional>
 #include <iostream>
+#include <iterator>
 #include <string>
 #include <thread>
 
@@ -35,25 +40,57 @@ namespace Before
     };
 }
 
-using namespace Before;
-
-void run(Logger& logger, int id)
+void run(Before::Logger& logger, int id)
 {
     for (int i = 0; i < 1000; ++i)
         logger.log("Log#" + to_string(id) + " - Event#" + to_string(i));
 }
 
+template <typename TSink>
+void run(After::Logger<TSink>& logger, int id)
+{
+    for (int i = 0; i < 1000; ++i)
+        logger.log("Log#{} - Event#{}", id, i); // no temporary strings - formatted by the writer thread
+}
+
+void run(After::MappedFileSink& sink, int id)
+{
+    string line;
+    for (int i = 0; i < 1000; ++i)
+    {
+        line.clear();
+        format_to(back_inserter(line), "Log#{} - Event#{}\n", id, i);
+        sink.write(line); // lock-free copy into the mapped segment
+    }
+}
+
+template <typename TMakeLogger>
+void benchmark_logger(const string& name, const string& file_name, TMakeLogger make_logger)
+{
+    const auto start = chrono::high_resolution_clock::now();
+
+    {
+        auto logger = make_logger(file_name);
+
+        jthread thd1([&logger] { run(logger, 1); });
+        jthread thd2([&logger] { run(logger, 2); });
+    } // includes draining & writing of the async loggers
+
+    const auto end = chrono::high_resolution_clock::now();
+    cout << name << " - elapsed time: " << chrono::duration_cast<chrono::microseconds>(end - start).count() << "us, "
+         << filesystem::file_size(file_name) << " bytes" << endl;
+}
+
 int main()
 {
-    /*
-     * TODO: Write a Logger class which is thread-safe
-     */
+    // not thread-safe - lines may interleave
+    benchmark_logger("ofstream + flush per line", "data_before.log", [](const string& file_name) { return Before::Logger{file_name}; });
 
-    Logger log("data.log");
+    benchmark_logger("async text logger", "data.log", [](const string& file_name) { return After::Logger{After::FileSink{file_name}}; });
 
-    thread thd1(&run, ref(log), 1);
-    thread thd2(&run, ref(log), 2);
+    // decoder/log_decoder data.blog - prints it as text with timestamps & thread ids
+    benchmark_logger("async binary logger", "data.blog", [](const string& file_name) { return After::Logger{After::BinaryFileSink{file_name}}; });
 
-    thd1.join();
-    thd2.join();
+    // threads write straight into the mapped segment data_mapped.log.0
+    benchmark_logger("mmap sink", "data_mapped.log.0", [](const string&) { return After::MappedFileSink{"data_mapped.log", 1024 * 1024}; });
 }
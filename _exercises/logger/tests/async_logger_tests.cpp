@@ -0,0 +1,118 @@
+#include "async_logger.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// collects the text in memory - read it after the logger is destroyed
+struct MemorySink
+{
+    shared_ptr<string> text = make_shared<string>();
+
+    void append(string& batch, const After::LogRecord& record)
+    {
+        record.format_to(batch);
+        batch.push_back('\n');
+    }
+
+    void write(string_view data)
+    {
+        text->append(data);
+    }
+
+    void flush()
+    {
+    }
+};
+
+// another sink type - a Logger<OtherSink> is a different class than a Logger<MemorySink>
+struct OtherSink : MemorySink
+{
+};
+
+vector<string> lines_of(const string& text)
+{
+    vector<string> lines;
+    istringstream in{text};
+    for (string line; getline(in, line);)
+        lines.push_back(line);
+    return lines;
+}
+
+static_assert(After::Details::LogArgument<const char*>);
+static_assert(After::Details::LogArgument<byte>);
+static_assert(After::Details::LogArgument<const void*>);
+static_assert(!After::Details::LogArgument<int*>); // the pointee may be gone before the writer formats it
+static_assert(!After::Details::LogArgument<string_view*>);
+
+TEST_CASE("Logger")
+{
+    MemorySink sink;
+    auto text = sink.text;
+
+    SECTION("formats records on the writer thread")
+    {
+        {
+            After::Logger log{sink};
+            log.log("plain");
+            log.log("a={} b={} c={}", 1, string{"two"}, 3.5);
+        }
+
+        REQUIRE(lines_of(*text) == vector<string>{"plain", "a=1 b=two c=3.5"});
+    }
+
+    SECTION("logs a null C-string as (null)")
+    {
+        {
+            After::Logger log{sink};
+            const char* name = nullptr;
+            log.log("name={}", name);
+        }
+
+        REQUIRE(lines_of(*text) == vector<string>{"name=(null)"});
+    }
+
+    SECTION("thread alternating between two loggers keeps one ring per logger")
+    {
+        MemorySink other_sink;
+        auto other_text = other_sink.text;
+
+        {
+            After::Logger log1{sink};
+            After::Logger log2{other_sink};
+
+            for (int i = 0; i < 1000; ++i)
+            {
+                log1.log("first {}", i);
+                log2.log("second {}", i);
+            }
+
+            REQUIRE(log1.ring_count() == 1);
+            REQUIRE(log2.ring_count() == 1);
+        }
+
+        REQUIRE(lines_of(*text).size() == 1000);
+        REQUIRE(lines_of(*other_text).size() == 1000);
+    }
+
+    SECTION("loggers with different sinks used by one thread don't share a ring")
+    {
+        OtherSink other_sink;
+        auto other_text = other_sink.text;
+
+        {
+            After::Logger log1{sink};
+            After::Logger log2{other_sink};
+
+            log1.log("first");
+            log2.log("second");
+        }
+
+        REQUIRE(lines_of(*text) == vector<string>{"first"});
+        REQUIRE(lines_of(*other_text) == vector<string>{"second"});
+    }
+}
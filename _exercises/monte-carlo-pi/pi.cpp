@@ -1,9 +1,12 @@
+#include "../../thread-pool/cpu_topology.hpp"
+
 #include <atomic>
 #include <chrono>
 #include <cstdlib>
 #include <ctime>
 #include <iostream>
 #include <random>
+#include <string>
 #include <thread>
 #include <future>
 
@@ -139,21 +142,29 @@ void mc_pi_one_thread()
     cout << "Elapsed = " << elapsed_time << "ms" << endl;
 }
 
-void mc_pi_many_threads()
+void mc_pi_many_threads(ThreadPlacement placement = ThreadPlacement::unpinned)
 {
     std::cout << "\n------------------------------------\n";
-    std::cout << "Pi calculation started! Many threads" << endl;
+    std::cout << "Pi calculation started! Many threads - " << (placement == ThreadPlacement::pinned ? "pinned" : "unpinned") << endl;
     const auto start = chrono::high_resolution_clock::now();
 
     int num_threads = std::max(std::thread::hardware_concurrency(), 1u);
     std::vector<uintmax_t> hits_from_thread(num_threads);
 
+    const std::vector<int> cpus = CpuTopology{}.cpus_by_node(); // threads fill one NUMA node after another
+
     {
         std::vector<std::jthread> threads;
 
         for (int i = 0; i < num_threads; i++)
         {
-            threads.push_back(std::jthread{calc_hits_per_thread, int(N / num_threads), std::ref(hits_from_thread[i])});
+            const int cpu = cpus[i % cpus.size()];
+            threads.push_back(std::jthread{[=, &hits = hits_from_thread[i]] {
+                // pinned by the thread itself before it starts counting - no samples run on another cpu
+                if (placement == ThreadPlacement::pinned && !pin_this_thread_to_cpu(cpu))
+                    std::cout << "Thread #" + std::to_string(i) + " could not be pinned to cpu " + std::to_string(cpu) + "\n";
+                calc_hits_per_thread(int(N / num_threads), hits);
+            }});
         }
     } // join
 
@@ -320,7 +331,9 @@ int main()
 {
     mc_pi_one_thread();
 
-    mc_pi_many_threads();
+    mc_pi_many_threads(ThreadPlacement::unpinned);
+
+    mc_pi_many_threads(ThreadPlacement::pinned);
 
     mc_pi_many_threads_with_local_counter();
 
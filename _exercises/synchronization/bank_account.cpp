@@ -1,7 +1,16 @@
+#include "cache_line.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
 #include <iostream>
 #include <thread>
 #include <syncstream>
 #include <mutex>
+#include <string>
+#include <utility>
 
 class BankAccount
 {
@@ -62,46 +71,190 @@ public:
     }
 };
 
-void make_withdraws(BankAccount& ba, int no_of_operations)
+namespace Sharded
+{
+    // balance in integer cents in one atomic
+    // - withdraw/deposit are a single fetch_sub/fetch_add (wait-free) instead of a CAS loop -
+    //   overdrafts are never rejected, so a CAS loop would only re-implement them
+    // - transfer locks the shards of both accounts in a fixed order (no deadlock) - total_balance() takes
+    //   the same shards, so it never sees the amount on neither account while a transfer is in progress
+    class BankAccount
+    {
+        static constexpr size_t no_of_shards = 64;
+
+        struct alignas(Hardware::cache_line_size) Shard
+        {
+            std::mutex mtx;
+        };
+
+        const int id_;
+        alignas(Hardware::cache_line_size) std::atomic<std::int64_t> balance_; // cents - no false sharing between accounts
+
+        static std::int64_t to_cents(double amount)
+        {
+            return std::llround(amount * 100);
+        }
+
+        static size_t shard_index(const BankAccount& account)
+        {
+            return reinterpret_cast<std::uintptr_t>(&account) / alignof(BankAccount) % no_of_shards;
+        }
+
+        // locks shards in index order - one lock when both accounts share a shard
+        static std::pair<std::unique_lock<std::mutex>, std::unique_lock<std::mutex>> lock_shards(const BankAccount& a, const BankAccount& b)
+        {
+            static Shard shards[no_of_shards];
+
+            const size_t first = std::min(shard_index(a), shard_index(b));
+            const size_t second = std::max(shard_index(a), shard_index(b));
+            if (first == second)
+                return {std::unique_lock{shards[first].mtx}, std::unique_lock<std::mutex>{}};
+
+            std::unique_lock lk_first{shards[first].mtx};
+            std::unique_lock lk_second{shards[second].mtx};
+            return {std::move(lk_first), std::move(lk_second)};
+        }
+
+    public:
+        BankAccount(int id, double balance)
+            : id_(id)
+            , balance_(to_cents(balance))
+        {
+        }
+
+        void print() const
+        {
+            std::osyncstream synced_out{std::cout};
+            synced_out << "Bank Account #" << id_ << "; Balance = " << balance() << std::endl;
+        }
+
+        void transfer(BankAccount& to, double amount)
+        {
+            const std::int64_t cents = to_cents(amount);
+
+            auto locks = lock_shards(*this, to);
+            balance_.fetch_sub(cents, std::memory_order_relaxed);
+            to.balance_.fetch_add(cents, std::memory_order_relaxed);
+        }
+
+        void withdraw(double amount)
+        {
+            balance_.fetch_sub(to_cents(amount), std::memory_order_relaxed);
+        }
+
+        void deposit(double amount)
+        {
+            balance_.fetch_add(to_cents(amount), std::memory_order_relaxed);
+        }
+
+        int id() const
+        {
+            return id_;
+        }
+
+        double balance() const
+        {
+            return static_cast<double>(balance_.load(std::memory_order_relaxed)) / 100;
+        }
+
+        // consistent with transfers between a and b
+        static double total_balance(const BankAccount& a, const BankAccount& b)
+        {
+            auto locks = lock_shards(a, b);
+            return static_cast<double>(a.balance_.load(std::memory_order_relaxed) + b.balance_.load(std::memory_order_relaxed)) / 100;
+        }
+    };
+}
+
+template <typename TBankAccount>
+void make_withdraws(TBankAccount& ba, int no_of_operations)
 {
     for (int i = 0; i < no_of_operations; ++i)
         ba.withdraw(1.0);
 }
 
-void make_deposits(BankAccount& ba, int no_of_operations)
+template <typename TBankAccount>
+void make_deposits(TBankAccount& ba, int no_of_operations)
 {
     for (int i = 0; i < no_of_operations; ++i)
         ba.deposit(1.0);
 }
 
-void make_transfers(BankAccount& ba_from, BankAccount& ba_to, int no_of_operations)
+template <typename TBankAccount>
+void make_transfers(TBankAccount& ba_from, TBankAccount& ba_to, int no_of_operations)
 {
     for (int i = 0; i < no_of_operations; ++i)
         ba_from.transfer(ba_to, 1.0);
 }
 
-int main()
+template <typename TBankAccount>
+void run_bank(const std::string& name, int no_of_iters)
 {
-    const int NO_OF_ITERS = 10'000'000;
+    std::cout << "\n" << name << "\n";
 
-    BankAccount ba1(1, 10'000);
-    BankAccount ba2(2, 10'000);
+    TBankAccount ba1(1, 10'000);
+    TBankAccount ba2(2, 10'000);
 
     std::cout << "Before threads are started: ";
     ba1.print();
     ba2.print();
 
-    std::thread thd1(&make_withdraws, std::ref(ba1), NO_OF_ITERS);
-    std::thread thd2(&make_deposits, std::ref(ba1), NO_OF_ITERS);
-    std::thread thd3(&make_transfers, std::ref(ba1), std::ref(ba2), NO_OF_ITERS);
-    std::thread thd4(&make_transfers, std::ref(ba2), std::ref(ba1), NO_OF_ITERS);
+    const auto start = std::chrono::high_resolution_clock::now();
+
+    std::thread thd1(&make_withdraws<TBankAccount>, std::ref(ba1), no_of_iters);
+    std::thread thd2(&make_deposits<TBankAccount>, std::ref(ba1), no_of_iters);
+    std::thread thd3(&make_transfers<TBankAccount>, std::ref(ba1), std::ref(ba2), no_of_iters);
+    std::thread thd4(&make_transfers<TBankAccount>, std::ref(ba2), std::ref(ba1), no_of_iters);
 
     thd1.join();
     thd2.join();
     thd3.join();
     thd4.join();
 
+    const auto end = std::chrono::high_resolution_clock::now();
+
     std::cout << "After all threads are done: ";
     ba1.print();
     ba2.print();
+    std::cout << "Elapsed time: " << std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count() << "ms" << std::endl;
+}
+
+// transfers in both directions while an auditor reads the total of both accounts - it must never change
+template <typename TBankAccount>
+void audit_transfers(int no_of_iters)
+{
+    TBankAccount ba1(1, 10'000);
+    TBankAccount ba2(2, 10'000);
+
+    std::atomic<bool> is_done{false};
+    int no_of_audits = 0;
+    int no_of_wrong_totals = 0;
+
+    std::thread auditor([&] {
+        while (!is_done.load())
+        {
+            if (TBankAccount::total_balance(ba1, ba2) != 20'000)
+                ++no_of_wrong_totals;
+            ++no_of_audits;
+        }
+    });
+
+    std::thread thd1(&make_transfers<TBankAccount>, std::ref(ba1), std::ref(ba2), no_of_iters);
+    std::thread thd2(&make_transfers<TBankAccount>, std::ref(ba2), std::ref(ba1), no_of_iters);
+
+    thd1.join();
+    thd2.join();
+    is_done = true;
+    auditor.join();
+
+    std::cout << "Audit of concurrent transfers: " << no_of_wrong_totals << " wrong totals in " << no_of_audits << " audits" << std::endl;
+}
+
+int main()
+{
+    const int NO_OF_ITERS = 10'000'000;
+
+    run_bank<BankAccount>("recursive_mutex per account:", NO_OF_ITERS);
+    run_bank<Sharded::BankAccount>("atomic cents + sharded transfer locks:", NO_OF_ITERS);
+    audit_transfers<Sharded::BankAccount>(NO_OF_ITERS / 10);
 }
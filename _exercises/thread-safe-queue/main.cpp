@@ -1,7 +1,58 @@
+#include "allocation_counter.hpp"
+#include "thread_safe_queue.hpp"
+
+#include <atomic>
+#include <chrono>
 #include <iostream>
+#include <string>
+#include <thread>
 
 using namespace std;
 
+template <typename TQueue>
+void benchmark_queue(const string& name, TQueue& queue)
+{
+    constexpr int no_of_operations = 1'000'000;
+
+    thread consumer{[&queue] {
+        int item;
+        for (int i = 0; i < no_of_operations; ++i)
+            queue.pop(item);
+    }};
+
+    this_thread::sleep_for(10ms); // let the consumer start before counting
+
+    const auto allocations_before = allocations_count.load();
+    const auto start = chrono::high_resolution_clock::now();
+
+    for (int i = 0; i < no_of_operations; ++i)
+        queue.push(i);
+
+    consumer.join();
+
+    const auto end = chrono::high_resolution_clock::now();
+    const auto allocations = allocations_count.load() - allocations_before;
+
+    cout << name << ": " << allocations << " allocations per " << no_of_operations << " push/pop; elapsed = "
+         << chrono::duration_cast<chrono::milliseconds>(end - start).count() << "ms" << endl;
+}
+
 int main()
 {
+    constexpr size_t capacity = 1024;
+
+    {
+        ThreadSafeQueue<int> queue{capacity};
+        benchmark_queue("std::queue", queue);
+    }
+
+    {
+        ThreadSafeQueue<int, RingBufferStorage<int>> queue{capacity};
+        benchmark_queue("RingBufferStorage", queue);
+    }
+
+    {
+        ThreadSafeQueue<int, RecyclingBlockStorage<int>> queue{capacity};
+        benchmark_queue("RecyclingBlockStorage", queue);
+    }
 }
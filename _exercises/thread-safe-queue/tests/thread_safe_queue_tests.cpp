@@ -8,6 +8,12 @@
 #include <thread>
 #include <iostream>
 #include <future>
+#include <iterator>
+#include <memory>
+#include <ranges>
+#include <stdexcept>
+#include <string>
+#include <vector>
 
 using namespace std;
 
@@ -89,4 +95,458 @@ TEST_CASE("ThreadSafeQueue")
 
         REQUIRE(none_of(items.begin(), items.end(), [](int x) { return x == 0; }));
     }
+
+    SECTION("push_range pushes all items in order")
+    {
+        vector<int> items = {1, 2, 3};
+
+        tsq.push_range(items);
+
+        vector<int> popped(3);
+        for (auto& item : popped)
+            REQUIRE(tsq.try_pop(item));
+
+        REQUIRE(popped == items);
+        REQUIRE(tsq.empty() == true);
+    }
+
+    SECTION("push_range copies from a view over an lvalue container")
+    {
+        vector<string> source = {"a", "b", "c"};
+        ThreadSafeQueue<string> strings;
+
+        strings.push_range(source | views::take(2));
+
+        vector<string> popped;
+        REQUIRE(strings.pop_bulk(back_inserter(popped), 32) == 2);
+        REQUIRE(popped == vector<string>{"a", "b"});
+        REQUIRE(source == vector<string>{"a", "b", "c"});
+    }
+
+    SECTION("pop_bulk drains up to max_n items")
+    {
+        tsq.push({1, 2, 3, 4, 5});
+
+        vector<int> items;
+        auto count = tsq.pop_bulk(back_inserter(items), 3);
+
+        REQUIRE(count == 3);
+        REQUIRE(items == vector{1, 2, 3});
+
+        count = tsq.try_pop_bulk(back_inserter(items), 32);
+
+        REQUIRE(count == 2);
+        REQUIRE(items == vector{1, 2, 3, 4, 5});
+        REQUIRE(tsq.empty() == true);
+    }
+
+    SECTION("pop_bulk with max_n == 0 returns 0 without waiting")
+    {
+        vector<int> items;
+
+        REQUIRE(tsq.pop_bulk(back_inserter(items), 0) == 0);
+        REQUIRE(items.empty());
+    }
+
+    SECTION("try_pop_bulk returns 0 when empty")
+    {
+        vector<int> items;
+
+        REQUIRE(tsq.try_pop_bulk(back_inserter(items), 32) == 0);
+        REQUIRE(items.empty());
+    }
+
+    SECTION("client waits in pop_bulk when poping from empty")
+    {
+        vector<int> items;
+
+        thread thd{[&tsq, &items] { tsq.pop_bulk(back_inserter(items), 32); }};
+
+        this_thread::sleep_for(100ms);
+        tsq.push_range(vector{1, 2});
+        thd.join();
+
+        REQUIRE(!items.empty());
+        REQUIRE(items.front() == 1);
+    }
+}
+
+struct ThrowingCopy
+{
+    int value;
+
+    ThrowingCopy(int value)
+        : value{value}
+    {
+    }
+
+    ThrowingCopy(const ThrowingCopy& other)
+        : value{other.value}
+    {
+        if (value < 0)
+            throw runtime_error("copy failed");
+    }
+
+    ThrowingCopy& operator=(const ThrowingCopy&) = default;
+};
+
+TEST_CASE("ThreadSafeQueue - push throws partway")
+{
+    ThreadSafeQueue<ThrowingCopy> tsq;
+
+    ThrowingCopy item{0};
+    chrono::steady_clock::duration wait_time{};
+    thread thd{[&tsq, &item, &wait_time] {
+        auto start = chrono::steady_clock::now();
+        tsq.pop_for(item, 2s); // finds the item even when not woken - after the timeout
+        wait_time = chrono::steady_clock::now() - start;
+    }};
+
+    this_thread::sleep_for(100ms);
+
+    SECTION("push_range wakes consumers for the items pushed before the throw")
+    {
+        vector<ThrowingCopy> items;
+        items.reserve(2);
+        items.emplace_back(1);
+        items.emplace_back(-1);
+        REQUIRE_THROWS_AS(tsq.push_range(items), runtime_error);
+    }
+
+    SECTION("push of initializer_list wakes consumers for the items pushed before the throw")
+    {
+        REQUIRE_THROWS_AS(tsq.push({ThrowingCopy{1}, ThrowingCopy{-1}}), runtime_error);
+    }
+
+    thd.join();
+    REQUIRE(wait_time < 1s);
+    REQUIRE(item.value == 1);
+}
+
+TEST_CASE("ThreadSafeQueue - move-only items")
+{
+    ThreadSafeQueue<unique_ptr<string>> tsq;
+
+    SECTION("push & pop move items")
+    {
+        tsq.push(make_unique<string>("text"));
+
+        unique_ptr<string> item;
+        tsq.pop(item);
+
+        REQUIRE(*item == "text");
+    }
+
+    SECTION("emplace constructs item in place")
+    {
+        tsq.emplace(new string("text"));
+
+        unique_ptr<string> item;
+        REQUIRE(tsq.try_pop(item));
+        REQUIRE(*item == "text");
+    }
+
+    SECTION("push_range moves from a range of rvalues")
+    {
+        vector<unique_ptr<string>> items;
+        items.push_back(make_unique<string>("a"));
+        items.push_back(make_unique<string>("b"));
+
+        tsq.push_range(ranges::subrange{make_move_iterator(items.begin()), make_move_iterator(items.end())});
+
+        vector<unique_ptr<string>> popped;
+        REQUIRE(tsq.pop_bulk(back_inserter(popped), 32) == 2);
+        REQUIRE(*popped[0] == "a");
+        REQUIRE(*popped[1] == "b");
+    }
+
+    SECTION("push_range moves from an rvalue container")
+    {
+        vector<unique_ptr<string>> items;
+        items.push_back(make_unique<string>("a"));
+        items.push_back(make_unique<string>("b"));
+
+        tsq.push_range(std::move(items));
+
+        vector<unique_ptr<string>> popped;
+        REQUIRE(tsq.pop_bulk(back_inserter(popped), 32) == 2);
+        REQUIRE(*popped[0] == "a");
+        REQUIRE(*popped[1] == "b");
+    }
+}
+
+TEST_CASE("ThreadSafeQueue - bounded")
+{
+    SECTION("try_push returns false when full")
+    {
+        ThreadSafeQueue<int> tsq{2};
+
+        REQUIRE(tsq.try_push(1));
+        REQUIRE(tsq.try_push(2));
+        REQUIRE(tsq.try_push(3) == false);
+        REQUIRE(tsq.size() == 2);
+    }
+
+    SECTION("push_for times out when full")
+    {
+        ThreadSafeQueue<int> tsq{1};
+        tsq.push(1);
+
+        auto t1 = chrono::steady_clock::now();
+        auto result = tsq.push_for(2, 100ms);
+        auto t2 = chrono::steady_clock::now();
+
+        REQUIRE(result == false);
+        REQUIRE(t2 - t1 >= 100ms);
+    }
+
+    SECTION("producer waits in push until consumer makes room")
+    {
+        ThreadSafeQueue<int> tsq{1};
+        tsq.push(1);
+
+        chrono::steady_clock::time_point t1;
+
+        thread thd{[&tsq, &t1] {
+            tsq.push(2);
+            t1 = chrono::steady_clock::now();
+        }};
+
+        this_thread::sleep_for(200ms);
+        chrono::steady_clock::time_point t2 = chrono::steady_clock::now();
+        int item;
+        tsq.pop(item);
+        thd.join();
+
+        REQUIRE(t1 >= t2);
+        REQUIRE(item == 1);
+        tsq.pop(item);
+        REQUIRE(item == 2);
+    }
+
+    SECTION("push_range blocks until all items are consumed")
+    {
+        ThreadSafeQueue<int> tsq{2};
+        vector<int> items;
+
+        thread consumer{[&tsq, &items] {
+            for (int i = 0; i < 5; ++i)
+            {
+                int item;
+                tsq.pop(item);
+                items.push_back(item);
+            }
+        }};
+
+        tsq.push_range(vector{1, 2, 3, 4, 5});
+        consumer.join();
+
+        REQUIRE(items == vector{1, 2, 3, 4, 5});
+    }
+
+    SECTION("drop_oldest evicts front items")
+    {
+        ThreadSafeQueue<int> tsq{2, OverflowPolicy::drop_oldest};
+
+        tsq.push({1, 2, 3});
+
+        vector<int> items;
+        tsq.try_pop_bulk(back_inserter(items), 32);
+        REQUIRE(items == vector{2, 3});
+    }
+
+    SECTION("drop_newest discards pushed items")
+    {
+        ThreadSafeQueue<int> tsq{2, OverflowPolicy::drop_newest};
+
+        tsq.push({1, 2, 3});
+        tsq.push(4);
+
+        vector<int> items;
+        tsq.try_pop_bulk(back_inserter(items), 32);
+        REQUIRE(items == vector{1, 2});
+    }
+}
+
+TEST_CASE("ThreadSafeQueue - timed & cancellable pop")
+{
+    ThreadSafeQueue<int> tsq;
+    int item = 0;
+
+    SECTION("pop_for returns false after timeout")
+    {
+        auto t1 = chrono::steady_clock::now();
+        auto result = tsq.pop_for(item, 100ms);
+        auto t2 = chrono::steady_clock::now();
+
+        REQUIRE(result == false);
+        REQUIRE(t2 - t1 >= 100ms);
+    }
+
+    SECTION("pop_for returns item pushed before timeout")
+    {
+        thread thd{[&tsq] {
+            this_thread::sleep_for(50ms);
+            tsq.push(1);
+        }};
+
+        auto result = tsq.pop_for(item, 5s);
+        thd.join();
+
+        REQUIRE(result);
+        REQUIRE(item == 1);
+    }
+
+    SECTION("pop_until returns false after deadline")
+    {
+        auto deadline = chrono::steady_clock::now() + 100ms;
+
+        REQUIRE(tsq.pop_until(item, deadline) == false);
+        REQUIRE(chrono::steady_clock::now() >= deadline);
+    }
+
+    SECTION("pop with stop_token returns false when stop is requested")
+    {
+        bool result = true;
+
+        jthread thd{[&tsq, &item, &result](stop_token stop_token) {
+            result = tsq.pop(item, stop_token);
+        }};
+
+        this_thread::sleep_for(50ms);
+        thd.request_stop();
+        thd.join();
+
+        REQUIRE(result == false);
+    }
+
+    SECTION("pop_for with stop_token returns false when stop is requested before timeout")
+    {
+        bool result = true;
+        auto t1 = chrono::steady_clock::now();
+
+        jthread thd{[&tsq, &item, &result](stop_token stop_token) {
+            result = tsq.pop_for(item, 5s, stop_token);
+        }};
+
+        this_thread::sleep_for(50ms);
+        thd.request_stop();
+        thd.join();
+
+        REQUIRE(result == false);
+        REQUIRE(chrono::steady_clock::now() - t1 < 5s);
+    }
+
+    SECTION("close wakes all waiting consumers")
+    {
+        const int size = 3;
+        vector<int> results(size, -1);
+        vector<thread> threads;
+
+        for (int i = 0; i < size; ++i)
+            threads.emplace_back([&tsq, &results, i] {
+                int item;
+                results[i] = tsq.pop(item);
+            });
+
+        this_thread::sleep_for(50ms);
+        tsq.close();
+
+        for (auto& thd : threads)
+            thd.join();
+
+        REQUIRE(all_of(results.begin(), results.end(), [](int r) { return r == 0; }));
+    }
+
+    SECTION("items pushed before close can still be popped")
+    {
+        tsq.push({1, 2});
+        tsq.close();
+
+        REQUIRE(tsq.pop(item));
+        REQUIRE(item == 1);
+        REQUIRE(tsq.pop(item));
+        REQUIRE(item == 2);
+        REQUIRE(tsq.pop(item) == false);
+    }
+
+    SECTION("push to closed queue throws")
+    {
+        tsq.close();
+
+        REQUIRE_THROWS_AS(tsq.push(1), std::runtime_error);
+        REQUIRE(tsq.try_push(1) == false);
+    }
+}
+
+TEST_CASE("ThreadSafeQueue - ring buffer storage")
+{
+    ThreadSafeQueue<int, RingBufferStorage<int>> tsq{4};
+
+    SECTION("pops items in FIFO order across wrap-around")
+    {
+        vector<int> items;
+
+        for (int round = 0; round < 3; ++round)
+        {
+            tsq.push({1, 2, 3});
+            tsq.try_pop_bulk(back_inserter(items), 32);
+        }
+
+        REQUIRE(items == vector{1, 2, 3, 1, 2, 3, 1, 2, 3});
+    }
+
+    SECTION("is full at storage capacity")
+    {
+        tsq.push({1, 2, 3, 4});
+
+        REQUIRE(tsq.try_push(5) == false);
+    }
+
+    SECTION("requires bounded capacity")
+    {
+        using Queue = ThreadSafeQueue<int, RingBufferStorage<int>>;
+
+        REQUIRE_THROWS_AS(Queue{Queue::unbounded}, std::invalid_argument);
+    }
+}
+
+TEST_CASE("ThreadSafeQueue - recycling block storage")
+{
+    ThreadSafeQueue<unique_ptr<string>, RecyclingBlockStorage<unique_ptr<string>, 4>> tsq;
+
+    SECTION("pops items in FIFO order across blocks")
+    {
+        for (int i = 0; i < 10; ++i)
+            tsq.push(make_unique<string>(to_string(i)));
+
+        vector<unique_ptr<string>> items;
+        tsq.pop_bulk(back_inserter(items), 32);
+
+        REQUIRE(items.size() == 10);
+        for (int i = 0; i < 10; ++i)
+            REQUIRE(*items[i] == to_string(i));
+    }
+
+    SECTION("keeps FIFO order when push and pop interleave")
+    {
+        vector<int> popped;
+        int next = 0;
+
+        for (int round = 0; round < 10; ++round)
+        {
+            for (int i = 0; i < 7; ++i)
+                tsq.push(make_unique<string>(to_string(next++)));
+
+            unique_ptr<string> item;
+            for (int i = 0; i < 5; ++i)
+            {
+                tsq.pop(item);
+                popped.push_back(stoi(*item));
+            }
+        }
+
+        for (size_t i = 0; i < popped.size(); ++i)
+            REQUIRE(popped[i] == static_cast<int>(i));
+    }
 }
@@ -1,3 +1,5 @@
+#include "../thread-pool/future.hpp"
+
 #include <cassert>
 #include <chrono>
 #include <functional>
@@ -138,14 +140,18 @@ void promise_demo()
     std::jthread thd_consumer{[f = std::move(f)] mutable { sync_cout() << "result: " << f.get() << "\n";}};
 }
 
+SharedStateSlabs spawned_task_states; // shared states of futures returned by spawn_task
+
 template <typename TTask>
 auto spawn_task(TTask&& task)
 {
     using TResult = decltype(task());
-    std::packaged_task<TResult()> pt(std::forward<TTask>(task));
-    std::future<TResult> f = pt.get_future();
+    Promise<TResult> promise{&spawned_task_states};
+    Future<TResult> f = promise.get_future();
 
-    std::jthread thd{std::move(pt)};
+    std::jthread thd{[promise = std::move(promise), task = std::forward<TTask>(task)]() mutable {
+        promise.set_result_of(task);
+    }};
     thd.detach();
 
     return f;
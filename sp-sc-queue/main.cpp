@@ -1,13 +1,17 @@
 #include <catch2/catch_test_macros.hpp>
 #include <catch2/benchmark/catch_benchmark_all.hpp>
 #include "sp_sc_queue.hpp"
+#include "mp_mc_queue.hpp"
+#include "../thread-pool/thread_safe_queue.hpp"
 #include <algorithm>
 #include <cassert>
 #include <deque>
 #include <fstream>
 #include <iostream>
+#include <limits>
 #include <list>
 #include <random>
+#include <stdexcept>
 #include <thread>
 #include <vector>
 
@@ -15,6 +19,31 @@ using namespace std;
 
 constexpr int n = 100'000;
 
+template <typename TWaitPolicy>
+uint64_t run_blocking_spsc(const std::vector<uint64_t>& data)
+{
+    auto queue = std::make_unique<LockFree::SingleProducerSingleConsumerQueue<uint64_t, n, TWaitPolicy>>();
+
+    std::atomic<uint64_t> items_processed{};
+    auto data_size = data.size();
+
+    thread consumer_thd([&queue, &items_processed, data_size]
+        {
+        uint64_t value;
+        for (size_t i = 0; i < data_size; ++i)
+            queue->deque(value);
+
+        items_processed = data_size; });
+
+    // producer
+    for (auto& item : data)
+        queue->enque(item);
+
+    consumer_thd.join();
+
+    return items_processed.load();
+}
+
 TEST_CASE("SPSC Queue")
 {
     std::vector<uint64_t> data(n);
@@ -89,4 +118,241 @@ TEST_CASE("SPSC Queue")
 
         return items_processed.load();
     };
+
+    // fewer shared index reads -> fewer cache line transfers between cores
+    // (compare e.g. with: perf stat -e cache-misses,LLC-load-misses)
+    BENCHMARK("lock free - cached indexes")
+    {
+        LockFreeWithCachedIndexes::SingleProducerSingleConsumerQueue<uint64_t, n> queue;
+
+        std::atomic<uint64_t> items_processed{};
+        auto data_size = data.size();
+
+        thread consumer_thd([&queue, &items_processed, data_size]
+            {
+            size_t local_items_processed = 0;
+            while (local_items_processed < data_size)
+            {
+                uint64_t value;
+                if (queue.try_deque(value))
+                {
+                    ++local_items_processed;
+                }
+            } 
+
+            items_processed = local_items_processed; });
+
+        // producer
+        for (auto& item : data)
+        {
+            while (!queue.try_enque(item))
+                continue;
+        }
+
+        consumer_thd.join();
+
+        return items_processed.load();
+    };
+
+    BENCHMARK("lock free - heap buffer, power of 2 capacity")
+    {
+        LockFreeDynamicSize::SingleProducerSingleConsumerQueue<uint64_t> queue(n);
+
+        std::atomic<uint64_t> items_processed{};
+        auto data_size = data.size();
+
+        thread consumer_thd([&queue, &items_processed, data_size]
+            {
+            size_t local_items_processed = 0;
+            while (local_items_processed < data_size)
+            {
+                uint64_t value;
+                if (queue.try_deque(value))
+                {
+                    ++local_items_processed;
+                }
+            } 
+
+            items_processed = local_items_processed; });
+
+        // producer
+        for (auto& item : data)
+        {
+            while (!queue.try_enque(item))
+                continue;
+        }
+
+        consumer_thd.join();
+
+        return items_processed.load();
+    };
+
+    BENCHMARK("lock free - blocking, busy spin")
+    {
+        return run_blocking_spsc<WaitPolicies::BusySpin>(data);
+    };
+
+    BENCHMARK("lock free - blocking, spin + pause")
+    {
+        return run_blocking_spsc<WaitPolicies::SpinPause>(data);
+    };
+
+    BENCHMARK("lock free - blocking, spin + yield")
+    {
+        return run_blocking_spsc<WaitPolicies::SpinYield>(data);
+    };
+
+    BENCHMARK("lock free - blocking, park")
+    {
+        return run_blocking_spsc<WaitPolicies::Park>(data);
+    };
+
+    for (size_t batch_size : {1, 8, 64, 512})
+    {
+        BENCHMARK("lock free - bulk of " + std::to_string(batch_size))
+        {
+            LockFree::SingleProducerSingleConsumerQueue<uint64_t, n> queue;
+
+            std::atomic<uint64_t> items_processed{};
+            auto data_size = data.size();
+
+            thread consumer_thd([&queue, &items_processed, data_size, batch_size]
+                {
+                std::vector<uint64_t> values(batch_size);
+                size_t local_items_processed = 0;
+                while (local_items_processed < data_size)
+                {
+                    local_items_processed += queue.try_deque_bulk(values);
+                } 
+
+                items_processed = local_items_processed; });
+
+            // producer
+            std::span<const uint64_t> items{data};
+            while (!items.empty())
+            {
+                auto batch = items.first(std::min(batch_size, items.size()));
+                items = items.subspan(queue.try_enque_bulk(batch));
+            }
+
+            consumer_thd.join();
+
+            return items_processed.load();
+        };
+    }
+}
+
+TEST_CASE("SPSC Queue - heap buffer capacity")
+{
+    using Queue = LockFreeDynamicSize::SingleProducerSingleConsumerQueue<uint64_t>;
+
+    REQUIRE(Queue(1000).capacity() == 1024);
+    REQUIRE(Queue(0).capacity() == 1);
+
+    REQUIRE_THROWS_AS(Queue((uint64_t{1} << 60) + 1), std::length_error); // buffer size overflows size_t
+    REQUIRE_THROWS_AS(Queue(std::numeric_limits<uint64_t>::max()), std::length_error); // bit_ceil() overflows
+}
+
+// direct measure of the cached indexes - how often each side still reads the index of the other one
+TEST_CASE("SPSC Queue - cached index reloads")
+{
+    auto queue = std::make_unique<LockFreeWithCachedIndexes::SingleProducerSingleConsumerQueue<uint64_t, 1024>>();
+
+    uint64_t deque_calls = 0;
+    thread consumer_thd([&queue, &deque_calls]
+        {
+        uint64_t value;
+        size_t items_dequed = 0;
+        while (items_dequed < n)
+        {
+            ++deque_calls;
+            if (queue->try_deque(value))
+                ++items_dequed;
+        } });
+
+    // producer
+    uint64_t enque_calls = 0;
+    size_t items_enqued = 0;
+    while (items_enqued < n)
+    {
+        ++enque_calls;
+        if (queue->try_enque(items_enqued))
+            ++items_enqued;
+    }
+
+    consumer_thd.join();
+
+    // every failed call reloads in both variants - the plain lock-free queue reloads also on each successful call (1 per item)
+    REQUIRE(queue->head_reloads() >= enque_calls - n);
+    REQUIRE(queue->tail_reloads() >= deque_calls - n);
+    const auto head_reloads_per_item = static_cast<double>(queue->head_reloads() - (enque_calls - n)) / n;
+    const auto tail_reloads_per_item = static_cast<double>(queue->tail_reloads() - (deque_calls - n)) / n;
+
+    cout << "cached indexes - reloads per item (plain lock-free: 1) - head: " << head_reloads_per_item
+         << ", tail: " << tail_reloads_per_item << endl;
+
+    REQUIRE(head_reloads_per_item <= 1.0);
+    REQUIRE(tail_reloads_per_item <= 1.0);
+}
+
+template <typename TPush, typename TPop>
+uint64_t run_producers_consumers(const std::vector<uint64_t>& data, size_t no_of_producers, size_t no_of_consumers, TPush push, TPop pop)
+{
+    std::atomic<uint64_t> items_processed{};
+
+    {
+        std::vector<std::jthread> threads;
+
+        const size_t items_per_consumer = data.size() / no_of_consumers;
+        for (size_t c = 0; c < no_of_consumers; ++c)
+            threads.emplace_back([&items_processed, items_per_consumer, pop]
+                {
+                uint64_t value;
+                for (size_t i = 0; i < items_per_consumer; ++i)
+                    pop(value);
+
+                items_processed += items_per_consumer; });
+
+        const size_t items_per_producer = data.size() / no_of_producers;
+        for (size_t p = 0; p < no_of_producers; ++p)
+            threads.emplace_back([&data, p, items_per_producer, push]
+                {
+                for (size_t i = p * items_per_producer; i < (p + 1) * items_per_producer; ++i)
+                    push(data[i]); });
+    } // join
+
+    return items_processed.load();
+}
+
+TEST_CASE("MPMC Queue")
+{
+    std::vector<uint64_t> data(n);
+    std::random_device rd;
+    std::mt19937_64 rnd_gen(rd());
+    std::uniform_int_distribution<uint64_t> distr(0, 1000);
+    std::generate_n(begin(data), n, [&]
+        { return distr(rnd_gen); });
+
+    for (size_t no_of_threads : {1, 2, 4, 8})
+    {
+        const auto config = std::to_string(no_of_threads) + " producers x " + std::to_string(no_of_threads) + " consumers";
+
+        BENCHMARK("ThreadSafeQueue - " + config)
+        {
+            ThreadSafeQueue<uint64_t> queue;
+
+            return run_producers_consumers(data, no_of_threads, no_of_threads,
+                [&queue](uint64_t item) { queue.push(item); },
+                [&queue](uint64_t& item) { queue.pop(item); });
+        };
+
+        BENCHMARK("lock free MPMC - " + config)
+        {
+            LockFree::MultiProducerMultiConsumerQueue<uint64_t> queue(n);
+
+            return run_producers_consumers(data, no_of_threads, no_of_threads,
+                [&queue](uint64_t item) { while (!queue.try_enque(item)) continue; },
+                [&queue](uint64_t& item) { while (!queue.try_deque(item)) continue; });
+        };
+    }
 }
\ No newline at end of file
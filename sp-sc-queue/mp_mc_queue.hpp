@@ -0,0 +1,108 @@
+#ifndef MULTI_PRODUCER_MULTI_CONSUMER_QUEUE
+#define MULTI_PRODUCER_MULTI_CONSUMER_QUEUE
+
+#include "cache_line.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <memory>
+
+namespace LockFree
+{
+    // bounded MPMC queue (D. Vyukov) - every cell carries a sequence number that tells
+    // whether it is ready for the producer (seq == pos) or for the consumer (seq == pos + 1)
+    template <typename T>
+    class MultiProducerMultiConsumerQueue
+    {
+        struct Cell
+        {
+            std::atomic<std::uint64_t> sequence;
+            T data;
+        };
+
+        const std::uint64_t capacity_;
+        const std::uint64_t mask_;
+        const std::unique_ptr<Cell[]> cells_;
+
+        alignas(Hardware::cache_line_size) std::atomic<std::uint64_t> enque_pos_{0};
+        alignas(Hardware::cache_line_size) std::atomic<std::uint64_t> deque_pos_{0};
+
+    public:
+        explicit MultiProducerMultiConsumerQueue(std::uint64_t capacity)
+            : capacity_{std::bit_ceil(std::max<std::uint64_t>(capacity, 2))}
+            , mask_{capacity_ - 1}
+            , cells_{std::make_unique<Cell[]>(capacity_)}
+        {
+            for (std::uint64_t i = 0; i < capacity_; ++i)
+                cells_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+
+        MultiProducerMultiConsumerQueue(const MultiProducerMultiConsumerQueue&) = delete;
+        MultiProducerMultiConsumerQueue& operator=(const MultiProducerMultiConsumerQueue&) = delete;
+
+        std::uint64_t capacity() const
+        {
+            return capacity_;
+        }
+
+        bool try_enque(const T& item) // any producer
+        {
+            Cell* cell;
+            auto pos = enque_pos_.load(std::memory_order_relaxed);
+
+            while (true)
+            {
+                cell = &cells_[pos & mask_];
+                const auto seq = cell->sequence.load(std::memory_order_acquire);
+                const auto diff = static_cast<std::int64_t>(seq - pos);
+
+                if (diff == 0) // cell is free - try to claim it
+                {
+                    if (enque_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                        break;
+                }
+                else if (diff < 0) // cell still holds an item from the previous lap - queue is full
+                    return false;
+                else // another producer claimed the cell
+                    pos = enque_pos_.load(std::memory_order_relaxed);
+            }
+
+            cell->data = item;
+            cell->sequence.store(pos + 1, std::memory_order_release); // hand the cell to consumers
+
+            return true;
+        }
+
+        bool try_deque(T& item) // any consumer
+        {
+            Cell* cell;
+            auto pos = deque_pos_.load(std::memory_order_relaxed);
+
+            while (true)
+            {
+                cell = &cells_[pos & mask_];
+                const auto seq = cell->sequence.load(std::memory_order_acquire);
+                const auto diff = static_cast<std::int64_t>(seq - (pos + 1));
+
+                if (diff == 0) // cell is filled - try to claim it
+                {
+                    if (deque_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                        break;
+                }
+                else if (diff < 0) // queue is empty
+                    return false;
+                else // another consumer claimed the cell
+                    pos = deque_pos_.load(std::memory_order_relaxed);
+            }
+
+            item = std::move(cell->data);
+            cell->sequence.store(pos + capacity_, std::memory_order_release); // hand the cell to producers of the next lap
+
+            return true;
+        }
+    };
+}
+
+#endif // MULTI_PRODUCER_MULTI_CONSUMER_QUEUE
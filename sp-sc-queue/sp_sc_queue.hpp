@@ -1,9 +1,89 @@
 #ifndef SINGLE_PRODUCER_SINGLE_CONSUMER_QUEUE
 #define SINGLE_PRODUCER_SINGLE_CONSUMER_QUEUE
 
+#include "cache_line.hpp"
+
+#include <algorithm>
 #include <array>
 #include <atomic>
+#include <bit>
+#include <cstdint>
+#include <limits>
+#include <memory>
 #include <mutex>
+#include <new>
+#include <span>
+#include <stdexcept>
+#include <thread>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#include <immintrin.h>
+#endif
+
+namespace WaitPolicies
+{
+    inline void cpu_relax()
+    {
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+        _mm_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+        asm volatile("yield");
+#endif
+    }
+
+    // backoff(spins) is called after every failed attempt of a blocking operation
+    // - returning false asks the queue to park the thread (only for policies that park)
+
+    struct BusySpin // lowest latency - burns a full core
+    {
+        static constexpr bool parks = false;
+
+        static bool backoff(unsigned int /*spins*/)
+        {
+            return true;
+        }
+    };
+
+    struct SpinPause // eases the pressure on the sibling hyper-thread and the memory bus
+    {
+        static constexpr bool parks = false;
+        static constexpr unsigned int spin_limit = 64;
+
+        static bool backoff(unsigned int spins)
+        {
+            if (spins >= spin_limit)
+                cpu_relax();
+            return true;
+        }
+    };
+
+    struct SpinYield // gives the core away to other runnable threads
+    {
+        static constexpr bool parks = false;
+        static constexpr unsigned int spin_limit = 64;
+
+        static bool backoff(unsigned int spins)
+        {
+            if (spins < spin_limit)
+                cpu_relax();
+            else
+                std::this_thread::yield();
+            return true;
+        }
+    };
+
+    struct Park // sleeps in std::atomic::wait - no CPU used while idle
+    {
+        static constexpr bool parks = true;
+        static constexpr unsigned int spin_limit = 256;
+
+        static bool backoff(unsigned int spins)
+        {
+            cpu_relax();
+            return spins < spin_limit;
+        }
+    };
+}
 
 namespace WithLocking
 {
@@ -48,12 +128,58 @@ namespace WithLocking
 
 namespace LockFree
 {
-    template <typename T, unsigned int N>
+    template <typename T, unsigned int N, typename TWaitPolicy = WaitPolicies::BusySpin>
     class SingleProducerSingleConsumerQueue
     {
         std::array<T, N> buffer_;
-        alignas(std::hardware_destructive_interference_size) std::atomic<unsigned int> head_{0};
-        alignas(std::hardware_destructive_interference_size) std::atomic<unsigned int> tail_{0};
+        alignas(Hardware::cache_line_size) std::atomic<unsigned int> head_{0};
+        std::atomic<bool> producer_parked_{false}; // used only by parking policies
+        alignas(Hardware::cache_line_size) std::atomic<unsigned int> tail_{0};
+        std::atomic<bool> consumer_parked_{false}; // used only by parking policies
+
+        void notify_consumer() // producer - after publishing tail_
+        {
+            if constexpr (TWaitPolicy::parks)
+            {
+                std::atomic_thread_fence(std::memory_order_seq_cst); // pairs with the fence in wait_for_item()
+                if (consumer_parked_.load(std::memory_order_relaxed))
+                    tail_.notify_one();
+            }
+        }
+
+        void notify_producer() // consumer - after publishing head_
+        {
+            if constexpr (TWaitPolicy::parks)
+            {
+                std::atomic_thread_fence(std::memory_order_seq_cst); // pairs with the fence in wait_for_space()
+                if (producer_parked_.load(std::memory_order_relaxed))
+                    head_.notify_one();
+            }
+        }
+
+        void wait_for_space(unsigned int tail) // producer
+        {
+            producer_parked_.store(true, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+
+            auto head = head_.load(std::memory_order_relaxed);
+            if (head + N == tail) // still full
+                head_.wait(head, std::memory_order_acquire);
+
+            producer_parked_.store(false, std::memory_order_relaxed);
+        }
+
+        void wait_for_item(unsigned int head) // consumer
+        {
+            consumer_parked_.store(true, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+
+            auto tail = tail_.load(std::memory_order_relaxed);
+            if (tail == head) // still empty
+                tail_.wait(tail, std::memory_order_acquire);
+
+            consumer_parked_.store(false, std::memory_order_relaxed);
+        }
 
     public:
         SingleProducerSingleConsumerQueue() = default;
@@ -70,6 +196,7 @@ namespace LockFree
 
             buffer_[tail % N] = item; // write to buffer
             tail_.store(tail + 1, std::memory_order_release); // update tail
+            notify_consumer();
 
             return true;
         }
@@ -83,6 +210,239 @@ namespace LockFree
 
             item = buffer_[head % N];
             head_.store(head + 1, std::memory_order_release); // update head
+            notify_producer();
+
+            return true;
+        }
+
+        void enque(const T& item) // producer - blocks according to TWaitPolicy
+        {
+            for (unsigned int spins = 0; !try_enque(item); ++spins)
+            {
+                if (!TWaitPolicy::backoff(spins))
+                    wait_for_space(tail_.load(std::memory_order_relaxed));
+            }
+        }
+
+        void deque(T& item) // consumer - blocks according to TWaitPolicy
+        {
+            for (unsigned int spins = 0; !try_deque(item); ++spins)
+            {
+                if (!TWaitPolicy::backoff(spins))
+                    wait_for_item(head_.load(std::memory_order_relaxed));
+            }
+        }
+
+        size_t try_enque_bulk(std::span<const T> items) // producer - returns number of enqued items
+        {
+            auto tail = tail_.load(std::memory_order_relaxed);
+
+            const size_t free_slots = N - (tail - head_.load(std::memory_order_acquire));
+            const size_t count = std::min(items.size(), free_slots);
+            if (count == 0)
+                return 0;
+
+            // at most two contiguous runs: [tail, N) and [0, rest)
+            const size_t first = tail % N;
+            const size_t first_run = std::min(count, N - first);
+            std::copy_n(items.begin(), first_run, buffer_.begin() + first);
+            std::copy_n(items.begin() + first_run, count - first_run, buffer_.begin());
+
+            tail_.store(tail + count, std::memory_order_release); // publish whole batch
+            notify_consumer();
+
+            return count;
+        }
+
+        size_t try_deque_bulk(std::span<T> items) // consumer - returns number of dequed items
+        {
+            auto head = head_.load(std::memory_order_relaxed);
+
+            const size_t available = tail_.load(std::memory_order_acquire) - head;
+            const size_t count = std::min(items.size(), available);
+            if (count == 0)
+                return 0;
+
+            const size_t first = head % N;
+            const size_t first_run = std::min(count, N - first);
+            std::copy_n(buffer_.begin() + first, first_run, items.begin());
+            std::copy_n(buffer_.begin(), count - first_run, items.begin() + first_run);
+
+            head_.store(head + count, std::memory_order_release); // release whole batch
+            notify_producer();
+
+            return count;
+        }
+    };
+}
+
+namespace LockFreeWithCachedIndexes
+{
+    // producer keeps a private copy of head_, consumer keeps a private copy of tail_
+    // - the shared index is re-read only when the cached copy says full/empty
+    template <typename T, unsigned int N>
+    class SingleProducerSingleConsumerQueue
+    {
+        std::array<T, N> buffer_;
+        alignas(Hardware::cache_line_size) std::atomic<unsigned int> head_{0};
+        unsigned int tail_cache_{0};    // consumer's copy of tail_
+        std::uint64_t tail_reloads_{0}; // consumer only - read after the threads are joined
+        alignas(Hardware::cache_line_size) std::atomic<unsigned int> tail_{0};
+        unsigned int head_cache_{0};    // producer's copy of head_
+        std::uint64_t head_reloads_{0}; // producer only - read after the threads are joined
+
+    public:
+        SingleProducerSingleConsumerQueue() = default;
+
+        SingleProducerSingleConsumerQueue(const SingleProducerSingleConsumerQueue&) = delete;
+        SingleProducerSingleConsumerQueue& operator=(const SingleProducerSingleConsumerQueue&) = delete;
+
+        // loads of the shared index of the other side - the plain lock-free queue does one per call
+        std::uint64_t head_reloads() const
+        {
+            return head_reloads_;
+        }
+
+        std::uint64_t tail_reloads() const
+        {
+            return tail_reloads_;
+        }
+
+        bool try_enque(const T& item) // producer
+        {
+            auto tail = tail_.load(std::memory_order_relaxed);
+
+            if (head_cache_ + N == tail) // buffer seems full - refresh cached head
+            {
+                head_cache_ = head_.load(std::memory_order_acquire);
+                ++head_reloads_;
+                if (head_cache_ + N == tail)
+                    return false;
+            }
+
+            buffer_[tail % N] = item;
+            tail_.store(tail + 1, std::memory_order_release);
+
+            return true;
+        }
+
+        bool try_deque(T& item) // consumer
+        {
+            auto head = head_.load(std::memory_order_relaxed);
+
+            if (tail_cache_ == head) // queue seems empty - refresh cached tail
+            {
+                tail_cache_ = tail_.load(std::memory_order_acquire);
+                ++tail_reloads_;
+                if (tail_cache_ == head)
+                    return false;
+            }
+
+            item = buffer_[head % N];
+            head_.store(head + 1, std::memory_order_release);
+
+            return true;
+        }
+    };
+}
+
+namespace LockFreeDynamicSize
+{
+    // capacity set at runtime and rounded up to a power of two - index = counter & mask
+    // 64-bit monotonic counters never wrap in practice, so any capacity is handled correctly
+    // - a capacity whose buffer would not fit in the address space throws std::length_error
+    template <typename T>
+    class SingleProducerSingleConsumerQueue
+    {
+        static constexpr std::align_val_t buffer_alignment{std::max(alignof(T), Hardware::cache_line_size)};
+
+        // largest power of two whose buffer size in bytes still fits in size_t
+        static constexpr std::uint64_t max_capacity = std::bit_floor(std::numeric_limits<size_t>::max() / sizeof(T));
+
+        const std::uint64_t capacity_;
+        const std::uint64_t mask_;
+        T* const buffer_;
+
+        alignas(Hardware::cache_line_size) std::atomic<std::uint64_t> head_{0};
+        std::uint64_t tail_cache_{0}; // consumer's copy of tail_
+        alignas(Hardware::cache_line_size) std::atomic<std::uint64_t> tail_{0};
+        std::uint64_t head_cache_{0}; // producer's copy of head_
+
+        static std::uint64_t round_up_capacity(std::uint64_t capacity)
+        {
+            if (capacity > max_capacity) // bit_ceil() or the size of the buffer would overflow
+                throw std::length_error("SPSC queue capacity is too large");
+
+            return std::bit_ceil(std::max<std::uint64_t>(capacity, 1));
+        }
+
+        static T* allocate_buffer(std::uint64_t capacity)
+        {
+            T* buffer = static_cast<T*>(::operator new(capacity * sizeof(T), buffer_alignment));
+            try
+            {
+                std::uninitialized_value_construct_n(buffer, capacity);
+            }
+            catch (...)
+            {
+                ::operator delete(buffer, buffer_alignment);
+                throw;
+            }
+            return buffer;
+        }
+
+    public:
+        explicit SingleProducerSingleConsumerQueue(std::uint64_t capacity)
+            : capacity_{round_up_capacity(capacity)}
+            , mask_{capacity_ - 1}
+            , buffer_{allocate_buffer(capacity_)}
+        {
+        }
+
+        SingleProducerSingleConsumerQueue(const SingleProducerSingleConsumerQueue&) = delete;
+        SingleProducerSingleConsumerQueue& operator=(const SingleProducerSingleConsumerQueue&) = delete;
+
+        ~SingleProducerSingleConsumerQueue()
+        {
+            std::destroy_n(buffer_, capacity_);
+            ::operator delete(buffer_, buffer_alignment);
+        }
+
+        std::uint64_t capacity() const
+        {
+            return capacity_;
+        }
+
+        bool try_enque(const T& item) // producer
+        {
+            auto tail = tail_.load(std::memory_order_relaxed);
+
+            if (tail - head_cache_ == capacity_) // buffer seems full - refresh cached head
+            {
+                head_cache_ = head_.load(std::memory_order_acquire);
+                if (tail - head_cache_ == capacity_)
+                    return false;
+            }
+
+            buffer_[tail & mask_] = item;
+            tail_.store(tail + 1, std::memory_order_release);
+
+            return true;
+        }
+
+        bool try_deque(T& item) // consumer
+        {
+            auto head = head_.load(std::memory_order_relaxed);
+
+            if (tail_cache_ == head) // queue seems empty - refresh cached tail
+            {
+                tail_cache_ = tail_.load(std::memory_order_acquire);
+                if (tail_cache_ == head)
+                    return false;
+            }
+
+            item = buffer_[head & mask_];
+            head_.store(head + 1, std::memory_order_release);
 
             return true;
         }
@@ -0,0 +1,402 @@
+#ifndef COROUTINE_TASK_HPP
+#define COROUTINE_TASK_HPP
+
+#include "future.hpp"
+
+#include <chrono>
+#include <condition_variable>
+#include <coroutine>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <queue>
+#include <stop_token>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace Coro
+{
+    template <typename T = void>
+    class Task;
+
+    namespace Details
+    {
+        class TaskPromiseBase
+        {
+            std::coroutine_handle<> continuation_ = std::noop_coroutine();
+            std::exception_ptr exception_;
+
+        protected:
+            void rethrow_if_failed() const
+            {
+                if (exception_)
+                    std::rethrow_exception(exception_);
+            }
+
+        public:
+            // resumes the awaiting coroutine without growing the stack (symmetric transfer)
+            struct FinalAwaiter
+            {
+                bool await_ready() const noexcept
+                {
+                    return false;
+                }
+
+                template <typename TPromise>
+                std::coroutine_handle<> await_suspend(std::coroutine_handle<TPromise> h) noexcept
+                {
+                    return h.promise().continuation_;
+                }
+
+                void await_resume() const noexcept
+                {
+                }
+            };
+
+            std::suspend_always initial_suspend() const noexcept // lazy - starts when awaited
+            {
+                return {};
+            }
+
+            FinalAwaiter final_suspend() const noexcept
+            {
+                return {};
+            }
+
+            void unhandled_exception()
+            {
+                exception_ = std::current_exception();
+            }
+
+            void set_continuation(std::coroutine_handle<> continuation)
+            {
+                continuation_ = continuation;
+            }
+        };
+
+        template <typename T>
+        class TaskPromise : public TaskPromiseBase
+        {
+            std::optional<T> value_;
+
+        public:
+            Task<T> get_return_object();
+
+            template <typename TValue>
+            void return_value(TValue&& value)
+            {
+                value_.emplace(std::forward<TValue>(value));
+            }
+
+            T result()
+            {
+                rethrow_if_failed();
+                return std::move(*value_);
+            }
+        };
+
+        template <>
+        class TaskPromise<void> : public TaskPromiseBase
+        {
+        public:
+            Task<void> get_return_object();
+
+            void return_void()
+            {
+            }
+
+            void result()
+            {
+                rethrow_if_failed();
+            }
+        };
+    }
+
+    // lazily started coroutine returning T - a suspended task occupies only its coroutine frame
+    template <typename T>
+    class [[nodiscard]] Task
+    {
+    public:
+        using promise_type = Details::TaskPromise<T>;
+
+    private:
+        std::coroutine_handle<promise_type> handle_;
+
+        explicit Task(std::coroutine_handle<promise_type> handle)
+            : handle_{handle}
+        {
+        }
+
+        friend promise_type;
+
+    public:
+        Task(Task&& other) noexcept
+            : handle_{std::exchange(other.handle_, nullptr)}
+        {
+        }
+
+        Task& operator=(Task&& other) noexcept
+        {
+            if (this != &other)
+            {
+                if (handle_)
+                    handle_.destroy();
+                handle_ = std::exchange(other.handle_, nullptr);
+            }
+            return *this;
+        }
+
+        Task(const Task&) = delete;
+        Task& operator=(const Task&) = delete;
+
+        ~Task()
+        {
+            if (handle_)
+                handle_.destroy();
+        }
+
+        auto operator co_await() && noexcept
+        {
+            struct Awaiter
+            {
+                std::coroutine_handle<promise_type> handle;
+
+                bool await_ready() const noexcept
+                {
+                    return false;
+                }
+
+                std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept
+                {
+                    handle.promise().set_continuation(awaiting);
+                    return handle; // starts the task in this thread
+                }
+
+                T await_resume()
+                {
+                    return handle.promise().result();
+                }
+            };
+
+            return Awaiter{handle_};
+        }
+    };
+
+    namespace Details
+    {
+        template <typename T>
+        Task<T> TaskPromise<T>::get_return_object()
+        {
+            return Task<T>{std::coroutine_handle<TaskPromise>::from_promise(*this)};
+        }
+
+        inline Task<void> TaskPromise<void>::get_return_object()
+        {
+            return Task<void>{std::coroutine_handle<TaskPromise>::from_promise(*this)};
+        }
+    }
+
+    // co_await ScheduleOn{pool} - the coroutine continues on a worker of the pool
+    template <typename TPool>
+    class ScheduleOn
+    {
+        TPool& pool_;
+
+    public:
+        explicit ScheduleOn(TPool& pool)
+            : pool_{pool}
+        {
+        }
+
+        bool await_ready() const noexcept
+        {
+            return false;
+        }
+
+        void await_suspend(std::coroutine_handle<> h)
+        {
+            pool_.submit([h] { h.resume(); });
+        }
+
+        void await_resume() const noexcept
+        {
+        }
+    };
+
+    // resumes sleeping coroutines on the pool when their deadlines pass - one thread for all of them
+    // must be destroyed before the pool and after all sleeping coroutines have been resumed
+    template <typename TPool>
+    class Timer
+    {
+        using Clock = std::chrono::steady_clock;
+
+        struct Sleeper
+        {
+            Clock::time_point deadline;
+            std::coroutine_handle<> handle;
+
+            bool operator>(const Sleeper& other) const
+            {
+                return deadline > other.deadline;
+            }
+        };
+
+        TPool& pool_;
+        std::priority_queue<Sleeper, std::vector<Sleeper>, std::greater<>> sleepers_;
+        std::mutex mtx_sleepers_;
+        std::condition_variable_any cv_sleepers_;
+        std::jthread thd_; // started last
+
+    public:
+        explicit Timer(TPool& pool)
+            : pool_{pool}
+            , thd_{[this](std::stop_token stop_token) { run(stop_token); }}
+        {
+        }
+
+        Timer(const Timer&) = delete;
+        Timer& operator=(const Timer&) = delete;
+
+        class SleepAwaiter
+        {
+            Timer& timer_;
+            Clock::time_point deadline_;
+
+        public:
+            SleepAwaiter(Timer& timer, Clock::time_point deadline)
+                : timer_{timer}
+                , deadline_{deadline}
+            {
+            }
+
+            bool await_ready() const noexcept
+            {
+                return Clock::now() >= deadline_;
+            }
+
+            void await_suspend(std::coroutine_handle<> h)
+            {
+                timer_.add(Sleeper{deadline_, h});
+            }
+
+            void await_resume() const noexcept
+            {
+            }
+        };
+
+        template <typename TRep, typename TPeriod>
+        SleepAwaiter sleep_for(std::chrono::duration<TRep, TPeriod> duration)
+        {
+            return SleepAwaiter{*this, Clock::now() + std::chrono::duration_cast<Clock::duration>(duration)};
+        }
+
+    private:
+        void add(Sleeper sleeper)
+        {
+            {
+                std::lock_guard lk{mtx_sleepers_};
+                sleepers_.push(sleeper);
+            }
+            cv_sleepers_.notify_one();
+        }
+
+        void run(std::stop_token stop_token)
+        {
+            std::unique_lock lk{mtx_sleepers_};
+
+            while (!stop_token.stop_requested())
+            {
+                if (sleepers_.empty())
+                {
+                    cv_sleepers_.wait(lk, stop_token, [this] { return !sleepers_.empty(); });
+                    continue;
+                }
+
+                const auto deadline = sleepers_.top().deadline;
+                if (Clock::now() < deadline)
+                {
+                    // wakes up earlier when a sleeper with a closer deadline arrives
+                    cv_sleepers_.wait_until(lk, stop_token, deadline, [this, deadline] { return sleepers_.top().deadline < deadline; });
+                    continue;
+                }
+
+                const std::coroutine_handle<> handle = sleepers_.top().handle;
+                sleepers_.pop();
+
+                lk.unlock();
+                pool_.submit([handle] { handle.resume(); });
+                lk.lock();
+            }
+        }
+    };
+
+    namespace Details
+    {
+        // fire-and-forget coroutine - its frame is freed when it completes
+        struct DetachedCoroutine
+        {
+            struct promise_type
+            {
+                DetachedCoroutine get_return_object() const noexcept
+                {
+                    return {};
+                }
+
+                std::suspend_never initial_suspend() const noexcept
+                {
+                    return {};
+                }
+
+                std::suspend_never final_suspend() const noexcept
+                {
+                    return {};
+                }
+
+                void return_void() const noexcept
+                {
+                }
+
+                void unhandled_exception() const noexcept
+                {
+                    std::terminate();
+                }
+            };
+        };
+
+        template <typename TPool, typename T>
+        DetachedCoroutine run_on(TPool& pool, Task<T> task, ::Promise<T> promise)
+        {
+            try
+            {
+                co_await ScheduleOn<TPool>{pool};
+
+                if constexpr (std::is_void_v<T>)
+                {
+                    co_await std::move(task);
+                    promise.set_value();
+                }
+                else
+                    promise.set_value(co_await std::move(task));
+            }
+            catch (...)
+            {
+                promise.set_exception(std::current_exception());
+            }
+        }
+    }
+
+    // starts task on the pool - the future gets its result (then/when_all work as for submitted tasks)
+    template <typename TPool, typename T>
+    Future<T> spawn(TPool& pool, Task<T> task)
+    {
+        ::Promise<T> promise;
+        Future<T> f_result = promise.get_future();
+        Details::run_on(pool, std::move(task), std::move(promise));
+        return f_result;
+    }
+} // namespace Coro
+
+#endif // COROUTINE_TASK_HPP
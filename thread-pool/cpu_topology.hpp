@@ -0,0 +1,168 @@
+#ifndef CPU_TOPOLOGY_HPP
+#define CPU_TOPOLOGY_HPP
+
+#include <algorithm>
+#include <cctype>
+#include <cstddef>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+enum class ThreadPlacement
+{
+    unpinned, // threads float over all cpus
+    pinned    // one thread per cpu, filled node by node
+};
+
+struct NumaNode
+{
+    int id;
+    std::vector<int> cpus;
+};
+
+// NUMA nodes from /sys/devices/system/node limited to the cpus this process may run on
+// - a single node with all allowed cpus when the kernel exposes no NUMA information
+class CpuTopology
+{
+    std::vector<NumaNode> nodes_;
+
+public:
+    CpuTopology()
+    {
+        const std::vector<int> allowed = allowed_cpus();
+
+        std::error_code ec;
+        for (const auto& entry : std::filesystem::directory_iterator{"/sys/devices/system/node", ec})
+        {
+            const std::string name = entry.path().filename().string();
+            if (name.rfind("node", 0) != 0 || name.size() == 4 || !std::all_of(name.begin() + 4, name.end(), [](unsigned char c) { return std::isdigit(c); }))
+                continue;
+
+            std::ifstream cpulist{entry.path() / "cpulist"};
+            std::string line;
+            std::getline(cpulist, line);
+
+            NumaNode node{std::stoi(name.substr(4)), {}};
+            for (int cpu : parse_cpu_list(line))
+                if (std::ranges::binary_search(allowed, cpu))
+                    node.cpus.push_back(cpu);
+
+            if (!node.cpus.empty())
+                nodes_.push_back(std::move(node));
+        }
+
+        if (nodes_.empty())
+            nodes_.push_back(NumaNode{0, allowed});
+
+        std::ranges::sort(nodes_, {}, &NumaNode::id);
+    }
+
+    const std::vector<NumaNode>& nodes() const
+    {
+        return nodes_;
+    }
+
+    // index in nodes() of the node owning cpu (0 when unknown)
+    size_t node_index_of(int cpu) const
+    {
+        for (size_t i = 0; i < nodes_.size(); ++i)
+            if (std::ranges::find(nodes_[i].cpus, cpu) != nodes_[i].cpus.end())
+                return i;
+        return 0;
+    }
+
+    // cpus of node 0, then node 1, ... - consecutive threads pinned in this order share a node
+    std::vector<int> cpus_by_node() const
+    {
+        std::vector<int> cpus;
+        for (const auto& node : nodes_)
+            cpus.insert(cpus.end(), node.cpus.begin(), node.cpus.end());
+        return cpus;
+    }
+
+    // "0-3,8,10-11" -> {0, 1, 2, 3, 8, 10, 11}
+    static std::vector<int> parse_cpu_list(const std::string& text)
+    {
+        std::vector<int> cpus;
+        std::istringstream in{text};
+        std::string range;
+        while (std::getline(in, range, ','))
+        {
+            if (range.empty() || !std::isdigit(static_cast<unsigned char>(range.front())))
+                continue;
+
+            const auto dash = range.find('-');
+            const int first = std::stoi(range.substr(0, dash));
+            const int last = dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+            for (int cpu = first; cpu <= last; ++cpu)
+                cpus.push_back(cpu);
+        }
+        return cpus;
+    }
+
+    static std::vector<int> allowed_cpus()
+    {
+        std::vector<int> cpus;
+#if defined(__linux__)
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        if (sched_getaffinity(0, sizeof(set), &set) == 0)
+        {
+            for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+                if (CPU_ISSET(cpu, &set))
+                    cpus.push_back(cpu);
+        }
+#endif
+        if (cpus.empty())
+            for (int cpu = 0; cpu < static_cast<int>(std::max(std::thread::hardware_concurrency(), 1u)); ++cpu)
+                cpus.push_back(cpu);
+        return cpus;
+    }
+};
+
+// best effort - returns false when the platform or the cpuset does not allow it
+inline bool pin_thread_to_cpu(std::thread::native_handle_type handle, int cpu)
+{
+#if defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return pthread_setaffinity_np(handle, sizeof(set), &set) == 0;
+#else
+    (void)handle;
+    (void)cpu;
+    return false;
+#endif
+}
+
+// pins the calling thread - call it first in the thread function, so none of its work
+// (and none of the memory it touches first) lands on another cpu before it is pinned
+inline bool pin_this_thread_to_cpu(int cpu)
+{
+#if defined(__linux__)
+    return pin_thread_to_cpu(pthread_self(), cpu);
+#else
+    (void)cpu;
+    return false;
+#endif
+}
+
+// cpu the calling thread is running on right now (-1 when unknown)
+inline int current_cpu()
+{
+#if defined(__linux__)
+    return sched_getcpu();
+#else
+    return -1;
+#endif
+}
+
+#endif // CPU_TOPOLOGY_HPP
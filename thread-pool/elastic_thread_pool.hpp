@@ -0,0 +1,257 @@
+#ifndef ELASTIC_THREAD_POOL_HPP
+#define ELASTIC_THREAD_POOL_HPP
+
+#include "future.hpp"
+#include "inline_task.hpp"
+#include "thread_safe_queue.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <list>
+#include <mutex>
+#include <stdexcept>
+#include <stop_token>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace Elastic
+{
+    using Task = InlineTask;
+
+    // Pool of min_threads..max_threads workers:
+    // - grows by one worker when a task waited longer than latency_threshold before it started,
+    //   or when no task started during a whole latency_threshold while tasks were queued (all workers blocked)
+    // - the supervisor polls every latency_threshold only while tasks are queued - it sleeps while the queue is empty
+    // - a worker above min_threads retires after idle_timeout without work
+    // - shutdown requests stop on all workers - they drain the queue and exit (no poison pills);
+    //   tasks submitted by the last running tasks after all workers have exited run on the destroying thread
+    class ThreadPool : public Executor
+    {
+        using Clock = std::chrono::steady_clock;
+
+        struct TimedTask
+        {
+            Task task;
+            Clock::time_point enqueued;
+        };
+
+    public:
+        ThreadPool(size_t min_threads, size_t max_threads,
+            Clock::duration latency_threshold = std::chrono::milliseconds{1},
+            Clock::duration idle_timeout = std::chrono::seconds{1})
+            : min_threads_{min_threads}
+            , max_threads_{max_threads}
+            , latency_threshold_{latency_threshold}
+            , idle_timeout_{idle_timeout}
+        {
+            if (min_threads_ == 0 || min_threads_ > max_threads_)
+                throw std::invalid_argument("Thread limits must satisfy 0 < min_threads <= max_threads");
+
+            live_threads_ = min_threads_;
+            {
+                std::lock_guard lk{mtx_workers_};
+                for (size_t i = 0; i < min_threads_; ++i)
+                    start_worker();
+            }
+
+            supervisor_ = std::jthread{[this](std::stop_token stop_token) { supervise(stop_token); }};
+        }
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        ThreadPool(ThreadPool&&) = delete;
+        ThreadPool& operator=(ThreadPool&&) = delete;
+
+        ~ThreadPool()
+        {
+            supervisor_.request_stop();
+            supervisor_.join();
+
+            {
+                std::lock_guard lk{mtx_workers_};
+                is_shutting_down_ = true; // workers list is frozen from now on
+            }
+
+            for (auto& worker : workers_)
+                worker.request_stop(); // wakes idle workers - they exit when the queue is drained
+
+            workers_.clear();
+            retired_.clear();
+
+            TimedTask timed_task;
+            while (tasks_.pop_for(timed_task, Clock::duration::zero()))
+            {
+                timed_task.task();
+                timed_task.task = nullptr;
+            }
+        }
+
+        template <typename TTask>
+        auto submit(TTask&& task)
+        {
+            using TResult = std::invoke_result_t<std::decay_t<TTask>&>;
+
+            Promise<TResult> promise{&shared_states_, this};
+            Future<TResult> f_result = promise.get_future();
+            execute([promise = std::move(promise), task = std::forward<TTask>(task)]() mutable {
+                promise.set_result_of(task);
+            });
+
+            return f_result;
+        }
+
+        void execute(Task task) override
+        {
+            submitted_.fetch_add(1); // seq_cst - pairs with parking of the supervisor
+            tasks_.emplace(std::move(task), Clock::now());
+
+            if (is_supervisor_parked_.load())
+            {
+                std::lock_guard lk{mtx_supervisor_}; // the supervisor is either before its check or already waiting
+                cv_supervisor_.notify_one();
+            }
+        }
+
+        // number of live workers
+        size_t size() const
+        {
+            return live_threads_.load();
+        }
+
+    private:
+        const size_t min_threads_;
+        const size_t max_threads_;
+        const Clock::duration latency_threshold_;
+        const Clock::duration idle_timeout_;
+
+        SharedStateSlabs shared_states_; // outlives queued tasks - declared first
+        ThreadSafeQueue<TimedTask, RecyclingBlockStorage<TimedTask>> tasks_;
+
+        std::atomic<size_t> live_threads_{0};
+        std::atomic<size_t> idle_threads_{0};
+        std::atomic<size_t> submitted_{0};
+        std::atomic<size_t> started_{0};
+
+        std::mutex mtx_workers_;
+        std::list<std::jthread> workers_; // stable iterators - a retiring worker removes itself
+        std::vector<std::jthread> retired_; // joined later by the thread that starts the next worker
+        bool is_shutting_down_ = false;
+
+        std::mutex mtx_supervisor_;
+        std::condition_variable_any cv_supervisor_;
+        std::atomic<bool> is_supervisor_parked_{false};
+        std::jthread supervisor_;
+
+        void start_worker() // under mtx_workers_
+        {
+            auto self = workers_.emplace(workers_.end());
+            *self = std::jthread{[this, self](std::stop_token stop_token) { run(stop_token, self); }};
+
+            retired_.clear(); // retired workers have already left run()
+        }
+
+        void try_grow()
+        {
+            size_t live = live_threads_.load();
+            do
+            {
+                if (live >= max_threads_)
+                    return;
+            } while (!live_threads_.compare_exchange_weak(live, live + 1));
+
+            std::lock_guard lk{mtx_workers_};
+            if (is_shutting_down_)
+            {
+                --live_threads_;
+                return;
+            }
+            start_worker();
+        }
+
+        bool try_retire()
+        {
+            size_t live = live_threads_.load();
+            do
+            {
+                if (live <= min_threads_)
+                    return false;
+            } while (!live_threads_.compare_exchange_weak(live, live - 1));
+
+            return true;
+        }
+
+        void run(std::stop_token stop_token, std::list<std::jthread>::iterator self)
+        {
+            TimedTask timed_task;
+            while (true)
+            {
+                idle_threads_.fetch_add(1);
+                const bool has_task = tasks_.pop_for(timed_task, idle_timeout_, stop_token); // keeps popping after stop until drained
+                idle_threads_.fetch_sub(1);
+
+                if (has_task)
+                {
+                    started_.fetch_add(1, std::memory_order_relaxed);
+
+                    if (Clock::now() - timed_task.enqueued > latency_threshold_ && idle_threads_.load() == 0)
+                        try_grow();
+
+                    timed_task.task(); // running task in this thread
+                    timed_task.task = nullptr;
+                    continue;
+                }
+
+                if (stop_token.stop_requested())
+                    return;
+
+                if (try_retire())
+                {
+                    std::lock_guard lk{mtx_workers_};
+                    if (!is_shutting_down_) // otherwise the destructor joins this worker
+                    {
+                        retired_.push_back(std::move(*self));
+                        workers_.erase(self);
+                    }
+                    return;
+                }
+            }
+        }
+
+        bool has_queued_tasks() const
+        {
+            return submitted_.load() > started_.load();
+        }
+
+        // catches the case when all workers are blocked in long tasks and nobody pops the queue
+        // - polls only while tasks are queued, otherwise sleeps until execute() wakes it
+        void supervise(std::stop_token stop_token)
+        {
+            std::unique_lock lk{mtx_supervisor_};
+            while (!stop_token.stop_requested())
+            {
+                is_supervisor_parked_.store(true); // seq_cst - execute() either sees it or its task is seen below
+                const bool has_work = cv_supervisor_.wait(lk, stop_token, [this] { return has_queued_tasks(); });
+                is_supervisor_parked_.store(false);
+                if (!has_work)
+                    return;
+
+                size_t last_started = started_.load(std::memory_order_relaxed);
+                while (!cv_supervisor_.wait_for(lk, stop_token, latency_threshold_, [] { return false; }) && !stop_token.stop_requested())
+                {
+                    const size_t started = started_.load(std::memory_order_relaxed);
+                    if (started == last_started && has_queued_tasks())
+                        try_grow();
+                    else if (!has_queued_tasks())
+                        break;
+                    last_started = started;
+                }
+            }
+        }
+    };
+} // namespace Elastic
+
+#endif // ELASTIC_THREAD_POOL_HPP
@@ -0,0 +1,805 @@
+#ifndef FUTURE_HPP
+#define FUTURE_HPP
+
+#include "cache_line.hpp"
+#include "inline_task.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <optional>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <variant>
+#include <vector>
+
+namespace Details
+{
+    // Slab of fixed-size slots for shared states owned by a single allocating thread.
+    // Slots freed by the owner go straight back to its local free list, slots freed by other threads
+    // are pushed on a lock-free stack that the owner takes over in one exchange when it runs dry.
+    // The slab is freed when its registry and its owner thread are gone and the last slot is freed.
+    class StateSlab
+    {
+    public:
+        static constexpr size_t slot_size = 192;
+        static constexpr size_t slots_per_chunk = 64;
+
+    private:
+        struct FreeSlot
+        {
+            FreeSlot* next;
+        };
+
+        static constexpr std::align_val_t slot_alignment{alignof(std::max_align_t)};
+
+        const std::thread::id owner_ = std::this_thread::get_id();
+        FreeSlot* local_free_ = nullptr; // owner only
+        std::vector<void*> chunks_;      // owner only
+        alignas(Hardware::cache_line_size) std::atomic<FreeSlot*> remote_free_{nullptr};
+        std::atomic<size_t> refs_{2}; // registry + owner thread + one per allocated slot
+        std::atomic<bool> is_orphaned_{false}; // owner thread has exited
+
+        ~StateSlab()
+        {
+            for (void* chunk : chunks_)
+                ::operator delete(chunk, slot_alignment);
+        }
+
+        void add_chunk()
+        {
+            auto* chunk = static_cast<std::byte*>(::operator new(slot_size * slots_per_chunk, slot_alignment));
+            chunks_.push_back(chunk);
+
+            for (size_t i = 0; i < slots_per_chunk; ++i)
+                local_free_ = ::new (chunk + i * slot_size) FreeSlot{local_free_};
+        }
+
+        void release_ref()
+        {
+            if (refs_.fetch_sub(1, std::memory_order_acq_rel) == 1)
+                delete this;
+        }
+
+    public:
+        StateSlab() = default;
+
+        StateSlab(const StateSlab&) = delete;
+        StateSlab& operator=(const StateSlab&) = delete;
+
+        void* allocate() // owner thread
+        {
+            if (local_free_ == nullptr)
+                local_free_ = remote_free_.exchange(nullptr, std::memory_order_acquire);
+
+            if (local_free_ == nullptr)
+                add_chunk();
+
+            FreeSlot* slot = local_free_;
+            local_free_ = slot->next;
+            refs_.fetch_add(1, std::memory_order_relaxed);
+            return slot;
+        }
+
+        void deallocate(void* ptr) // any thread
+        {
+            if (std::this_thread::get_id() == owner_ && !is_orphaned()) // an exited owner's id may be reused
+            {
+                local_free_ = ::new (ptr) FreeSlot{local_free_};
+            }
+            else
+            {
+                auto* slot = ::new (ptr) FreeSlot{remote_free_.load(std::memory_order_relaxed)};
+                while (!remote_free_.compare_exchange_weak(slot->next, slot, std::memory_order_release, std::memory_order_relaxed))
+                    continue;
+            }
+            release_ref();
+        }
+
+        void release() // registry is gone - the slab lives until the last slot is freed
+        {
+            release_ref();
+        }
+
+        void orphan() // owner thread exits - the slab lives until the last slot is freed
+        {
+            is_orphaned_.store(true, std::memory_order_release);
+            release_ref();
+        }
+
+        bool is_orphaned() const
+        {
+            return is_orphaned_.load(std::memory_order_acquire);
+        }
+
+        bool is_abandoned() const // owner thread only - the registry is gone and no slot is allocated
+        {
+            return refs_.load(std::memory_order_acquire) == 1;
+        }
+    };
+
+    // slabs owned by this thread - orphaned when the thread exits, so registries can drop them
+    class ThreadSlabs
+    {
+        std::vector<StateSlab*> slabs_; // one per registry this thread allocates from - a handful
+
+    public:
+        ~ThreadSlabs()
+        {
+            for (StateSlab* slab : slabs_)
+                slab->orphan();
+        }
+
+        static ThreadSlabs& this_thread()
+        {
+            thread_local ThreadSlabs slabs;
+            return slabs;
+        }
+
+        void add(StateSlab* slab)
+        {
+            std::erase_if(slabs_, [](StateSlab* slab) {
+                if (!slab->is_abandoned())
+                    return false;
+                slab->orphan(); // last reference - frees the slab
+                return true;
+            });
+
+            slabs_.push_back(slab);
+        }
+    };
+}
+
+// per-owner (e.g. per-pool) registry of state slabs - one slab per allocating thread
+class SharedStateSlabs
+{
+    inline static std::atomic<std::uint64_t> id_generator_{0};
+
+    const std::uint64_t id_ = ++id_generator_; // unique - never reused by another registry
+    std::mutex mtx_slabs_;
+    std::unordered_map<std::thread::id, Details::StateSlab*> slabs_;
+
+public:
+    SharedStateSlabs() = default;
+
+    SharedStateSlabs(const SharedStateSlabs&) = delete;
+    SharedStateSlabs& operator=(const SharedStateSlabs&) = delete;
+
+    ~SharedStateSlabs()
+    {
+        for (auto& [thread_id, slab] : slabs_)
+            slab->release();
+    }
+
+    Details::StateSlab& this_thread_slab()
+    {
+        struct CachedSlab
+        {
+            std::uint64_t owner_id = 0;
+            Details::StateSlab* slab = nullptr;
+        };
+        thread_local CachedSlab cached; // fast path for threads that keep submitting to the same owner
+
+        if (cached.owner_id == id_)
+            return *cached.slab;
+
+        std::lock_guard lk{mtx_slabs_};
+        auto it = slabs_.find(std::this_thread::get_id());
+        if (it == slabs_.end() || it->second->is_orphaned()) // orphaned - the id of an exited thread was reused
+        {
+            drop_orphaned_slabs(); // registered by threads that have exited since
+            auto* slab = new Details::StateSlab;
+            Details::ThreadSlabs::this_thread().add(slab);
+            it = slabs_.emplace(std::this_thread::get_id(), slab).first;
+        }
+
+        cached = {id_, it->second};
+        return *it->second;
+    }
+
+private:
+    void drop_orphaned_slabs()
+    {
+        std::erase_if(slabs_, [](const auto& entry) {
+            if (!entry.second->is_orphaned())
+                return false;
+            entry.second->release(); // freed when its last slot is freed
+            return true;
+        });
+    }
+};
+
+// runs tasks later (e.g. on the workers of a thread pool) - continuations of futures are scheduled here
+// - execute() is called by the thread that makes a future ready (often a worker of the same pool),
+//   so it must not block waiting for room in a bounded queue
+// - the executor (and the slabs of its states) must outlive every future whose continuation may still be
+//   scheduled on it - Future::then() only stores raw pointers; debug builds assert it with generations:
+//   every executor gets a new one, its destructor clears it - a new executor at the same address differs
+class Executor
+{
+public:
+    virtual void execute(InlineTask task) = 0;
+
+#ifndef NDEBUG
+    static std::uint64_t generation_of(const Executor* executor) // 0 - nullptr or destroyed
+    {
+        return executor ? executor->generation_.load(std::memory_order_relaxed) : 0;
+    }
+
+    // generation was taken from executor when it was stored - nullptr (continuation runs inline) is always alive
+    static bool is_alive(const Executor* executor, std::uint64_t generation)
+    {
+        return !executor || generation_of(executor) == generation;
+    }
+#endif
+
+protected:
+    Executor() = default;
+
+    Executor(const Executor&) = delete;
+    Executor& operator=(const Executor&) = delete;
+
+    ~Executor()
+    {
+#ifndef NDEBUG
+        generation_.store(0, std::memory_order_relaxed);
+#endif
+    }
+
+#ifndef NDEBUG
+private:
+    std::atomic<std::uint64_t> generation_{next_generation()};
+
+    static std::uint64_t next_generation()
+    {
+        static std::atomic<std::uint64_t> last_generation{0};
+        return last_generation.fetch_add(1, std::memory_order_relaxed) + 1;
+    }
+#endif
+};
+
+template <typename T>
+class Future;
+
+template <typename T>
+class Promise;
+
+namespace Details
+{
+    template <typename T>
+    class SharedState
+    {
+        static_assert(!std::is_reference_v<T>, "References are not supported");
+
+        using Value = std::conditional_t<std::is_void_v<T>, std::monostate, T>;
+
+        enum StatusBits : int
+        {
+            ready_bit = 1,       // value or exception is set
+            continuation_bit = 2 // continuation is attached
+        };
+
+        // whoever sets the second bit (producer or then()) schedules the continuation - exactly once
+        std::atomic<int> status_{0}; // int - waits directly on a futex
+        std::atomic<int> refs_{2};   // promise + future
+        StateSlab* const slab_;
+        SharedStateSlabs* const slabs_; // for states of continuations
+        Executor* const executor_;      // default executor of continuations
+        Executor* continuation_executor_ = nullptr;
+#ifndef NDEBUG
+        std::uint64_t executor_generation_ = Executor::generation_of(executor_); // when the pointers were stored
+        std::uint64_t continuation_executor_generation_ = 0;
+#endif
+        InlineTask continuation_;
+        std::optional<Value> value_;
+        std::exception_ptr exception_;
+
+        SharedState(StateSlab* slab, SharedStateSlabs* slabs, Executor* executor)
+            : slab_{slab}
+            , slabs_{slabs}
+            , executor_{executor}
+        {
+        }
+
+        void mark_ready()
+        {
+            const int status = status_.fetch_or(ready_bit, std::memory_order_acq_rel);
+            status_.notify_all();
+
+            if (status & continuation_bit)
+                schedule_continuation();
+        }
+
+        void schedule_continuation()
+        {
+            assert(Executor::is_alive(continuation_executor_, continuation_executor_generation_) && "continuation scheduled on a destroyed executor");
+
+            InlineTask continuation = std::move(continuation_);
+
+            if (continuation_executor_)
+                continuation_executor_->execute(std::move(continuation));
+            else
+                continuation(); // inline - in the thread that made the state ready
+        }
+
+    public:
+        static SharedState* create(SharedStateSlabs* slabs, Executor* executor)
+        {
+            if constexpr (sizeof(SharedState) <= StateSlab::slot_size && alignof(SharedState) <= alignof(std::max_align_t))
+            {
+                if (slabs)
+                {
+                    StateSlab& slab = slabs->this_thread_slab();
+                    return ::new (slab.allocate()) SharedState(&slab, slabs, executor);
+                }
+            }
+
+            return new SharedState(nullptr, slabs, executor);
+        }
+
+        void release()
+        {
+            if (refs_.fetch_sub(1, std::memory_order_acq_rel) != 1)
+                return;
+
+            if (StateSlab* slab = slab_)
+            {
+                this->~SharedState();
+                slab->deallocate(this);
+            }
+            else
+                delete this;
+        }
+
+        SharedStateSlabs* slabs() const
+        {
+            return slabs_;
+        }
+
+        Executor* executor() const
+        {
+            return executor_;
+        }
+
+#ifndef NDEBUG
+        bool is_executor_alive() const
+        {
+            return Executor::is_alive(executor_, executor_generation_);
+        }
+#endif
+
+        bool is_ready() const
+        {
+            return status_.load(std::memory_order_acquire) & ready_bit;
+        }
+
+        template <typename... TArgs>
+        void set_value(TArgs&&... args)
+        {
+            if (is_ready())
+                throw std::future_error(std::future_errc::promise_already_satisfied);
+
+            value_.emplace(std::forward<TArgs>(args)...);
+            mark_ready();
+        }
+
+        void set_exception(std::exception_ptr e)
+        {
+            if (is_ready())
+                throw std::future_error(std::future_errc::promise_already_satisfied);
+
+            exception_ = std::move(e);
+            mark_ready();
+        }
+
+        // continuation runs on executor (inline when nullptr) as soon as the state is ready
+        void set_continuation(Executor* executor, InlineTask continuation)
+        {
+            continuation_executor_ = executor;
+#ifndef NDEBUG
+            continuation_executor_generation_ = Executor::generation_of(executor);
+#endif
+            continuation_ = std::move(continuation);
+
+            if (status_.fetch_or(continuation_bit, std::memory_order_acq_rel) & ready_bit)
+                schedule_continuation();
+        }
+
+        void wait() const
+        {
+            int status;
+            while (!((status = status_.load(std::memory_order_acquire)) & ready_bit))
+                status_.wait(status, std::memory_order_acquire);
+        }
+
+        Value take()
+        {
+            wait();
+
+            if (exception_)
+                std::rethrow_exception(exception_);
+
+            return std::move(*value_);
+        }
+    };
+
+    // result of a continuation - f(value) or f() for futures of void
+    template <typename T, typename TFunction>
+    struct ContinuationResult
+    {
+        using type = std::invoke_result_t<TFunction&, T>;
+    };
+
+    template <typename TFunction>
+    struct ContinuationResult<void, TFunction>
+    {
+        using type = std::invoke_result_t<TFunction&>;
+    };
+}
+
+// lightweight replacement for std::future - get() can be called once
+template <typename T>
+class Future
+{
+    Details::SharedState<T>* state_ = nullptr;
+
+    explicit Future(Details::SharedState<T>* state)
+        : state_{state}
+    {
+    }
+
+    friend class Promise<T>;
+
+public:
+    Future() = default;
+
+    Future(Future&& other) noexcept
+        : state_{std::exchange(other.state_, nullptr)}
+    {
+    }
+
+    Future& operator=(Future&& other) noexcept
+    {
+        if (this != &other)
+        {
+            reset();
+            state_ = std::exchange(other.state_, nullptr);
+        }
+        return *this;
+    }
+
+    ~Future()
+    {
+        reset();
+    }
+
+    bool valid() const
+    {
+        return state_ != nullptr;
+    }
+
+    // like std::future - valid() must be true
+    bool is_ready() const
+    {
+        assert(valid() && "is_ready() on a future without a state");
+        return state_->is_ready();
+    }
+
+    void wait() const
+    {
+        assert(valid() && "wait() on a future without a state");
+        state_->wait();
+    }
+
+    T get()
+    {
+        if (!state_)
+            throw std::future_error(std::future_errc::no_state);
+
+        Future released{std::move(*this)}; // state is released even if get() throws
+
+        if constexpr (std::is_void_v<T>)
+            released.state_->take();
+        else
+            return released.state_->take();
+    }
+
+    // consumes the future - callback(ready_future) runs on executor (inline when nullptr)
+    // in the thread that makes the future ready, or right away if it is ready already
+    template <typename TCallback>
+    void on_ready(Executor* executor, TCallback callback)
+    {
+        if (!state_)
+            throw std::future_error(std::future_errc::no_state);
+
+        Details::SharedState<T>* state = state_;
+        state->set_continuation(executor, [source = std::move(*this), callback = std::move(callback)]() mutable {
+            callback(std::move(source));
+        });
+    }
+
+    // consumes the future - f(value) is scheduled on the executor of the future (e.g. the pool that produced it)
+    // exceptions skip f and propagate to the returned future; that pool must still be alive - the state
+    // of the returned future is allocated from its slabs
+    template <typename TFunction>
+    auto then(TFunction f)
+    {
+        if (!state_)
+            throw std::future_error(std::future_errc::no_state);
+
+        return then(state_->executor(), std::move(f));
+    }
+
+    template <typename TFunction>
+    auto then(Executor* executor, TFunction f)
+    {
+        using TResult = typename Details::ContinuationResult<T, TFunction>::type;
+
+        if (!state_)
+            throw std::future_error(std::future_errc::no_state);
+
+        // the state of the continuation comes from the slabs of the pool that produced this future
+        assert(state_->is_executor_alive() && "then() on a future of a destroyed pool");
+        assert((!executor || Executor::generation_of(executor) != 0) && "then() with a destroyed executor");
+
+        Promise<TResult> promise{state_->slabs(), executor};
+        Future<TResult> f_result = promise.get_future();
+
+        on_ready(executor, [promise = std::move(promise), f = std::move(f)](Future<T> source) mutable {
+            try
+            {
+                if constexpr (std::is_void_v<T>)
+                {
+                    source.get();
+                    promise.set_result_of(f);
+                }
+                else
+                {
+                    auto invoke_f = [&f, value = source.get()]() mutable -> TResult {
+                        return std::invoke(f, std::move(value));
+                    };
+                    promise.set_result_of(invoke_f);
+                }
+            }
+            catch (...) // exception of the source future
+            {
+                promise.set_exception(std::current_exception());
+            }
+        });
+
+        return f_result;
+    }
+
+private:
+    void reset()
+    {
+        if (state_)
+            std::exchange(state_, nullptr)->release();
+    }
+};
+
+// lightweight replacement for std::promise - the shared state is allocated from the slab
+// of the calling thread in slabs (or from the heap when slabs is nullptr)
+template <typename T>
+class Promise
+{
+    Details::SharedState<T>* state_;
+    bool future_retrieved_ = false;
+
+public:
+    // continuations of the future are scheduled on executor unless then() names another one
+    explicit Promise(SharedStateSlabs* slabs = nullptr, Executor* executor = nullptr)
+        : state_{Details::SharedState<T>::create(slabs, executor)}
+    {
+    }
+
+    Promise(Promise&& other) noexcept
+        : state_{std::exchange(other.state_, nullptr)}
+        , future_retrieved_{other.future_retrieved_}
+    {
+    }
+
+    Promise& operator=(Promise&& other) noexcept
+    {
+        if (this != &other)
+        {
+            abandon();
+            state_ = std::exchange(other.state_, nullptr);
+            future_retrieved_ = other.future_retrieved_;
+        }
+        return *this;
+    }
+
+    ~Promise()
+    {
+        abandon();
+    }
+
+    Future<T> get_future()
+    {
+        if (future_retrieved_)
+            throw std::future_error(std::future_errc::future_already_retrieved);
+
+        future_retrieved_ = true;
+        return Future<T>{state_};
+    }
+
+    template <typename... TArgs>
+    void set_value(TArgs&&... args)
+    {
+        state_->set_value(std::forward<TArgs>(args)...);
+    }
+
+    void set_exception(std::exception_ptr e)
+    {
+        state_->set_exception(std::move(e));
+    }
+
+    // invokes f and stores its result or exception
+    template <typename TFunction>
+    void set_result_of(TFunction& f)
+    {
+        try
+        {
+            if constexpr (std::is_void_v<T>)
+            {
+                std::invoke(f);
+                set_value();
+            }
+            else
+                set_value(std::invoke(f));
+        }
+        catch (...)
+        {
+            set_exception(std::current_exception());
+        }
+    }
+
+private:
+    void abandon()
+    {
+        if (!state_)
+            return;
+
+        if (!state_->is_ready())
+            state_->set_exception(std::make_exception_ptr(std::future_error(std::future_errc::broken_promise)));
+
+        if (!future_retrieved_)
+            state_->release(); // reference reserved for the future
+        std::exchange(state_, nullptr)->release();
+    }
+};
+
+// ready when all futures are ready - values in the order of futures, or the first exception
+// no thread is blocked while waiting - the last ready future completes the result in its own thread
+template <typename T>
+auto when_all(std::vector<Future<T>> futures)
+{
+    using TResult = std::conditional_t<std::is_void_v<T>, void, std::vector<T>>;
+    using Value = std::conditional_t<std::is_void_v<T>, std::monostate, T>;
+
+    struct AllState
+    {
+        std::atomic<size_t> remaining;
+        std::vector<std::optional<Value>> values;
+        Promise<TResult> promise;
+        std::mutex mtx_exception;
+        std::exception_ptr exception;
+
+        explicit AllState(size_t count)
+            : remaining{count}
+            , values(count)
+        {
+        }
+
+        void complete()
+        {
+            if (exception)
+            {
+                promise.set_exception(exception);
+            }
+            else if constexpr (std::is_void_v<T>)
+            {
+                promise.set_value();
+            }
+            else
+            {
+                std::vector<T> results;
+                results.reserve(values.size());
+                for (auto& value : values)
+                    results.push_back(std::move(*value));
+                promise.set_value(std::move(results));
+            }
+        }
+    };
+
+    auto all = std::make_shared<AllState>(futures.size());
+    Future<TResult> f_result = all->promise.get_future();
+
+    if (futures.empty())
+        all->complete();
+
+    for (size_t i = 0; i < futures.size(); ++i)
+    {
+        futures[i].on_ready(nullptr, [all, i](Future<T> f) {
+            try
+            {
+                if constexpr (std::is_void_v<T>)
+                {
+                    f.get();
+                    all->values[i].emplace();
+                }
+                else
+                    all->values[i].emplace(f.get());
+            }
+            catch (...)
+            {
+                std::lock_guard lk{all->mtx_exception};
+                if (!all->exception)
+                    all->exception = std::current_exception();
+            }
+
+            if (all->remaining.fetch_sub(1, std::memory_order_acq_rel) == 1)
+                all->complete();
+        });
+    }
+
+    return f_result;
+}
+
+// ready when the first of futures is ready - its index (and value), or its exception
+template <typename T>
+auto when_any(std::vector<Future<T>> futures)
+{
+    using TResult = std::conditional_t<std::is_void_v<T>, size_t, std::pair<size_t, T>>;
+
+    if (futures.empty())
+        throw std::invalid_argument("when_any of no futures");
+
+    struct AnyState
+    {
+        std::atomic<bool> is_done{false};
+        Promise<TResult> promise;
+    };
+
+    auto any = std::make_shared<AnyState>();
+    Future<TResult> f_result = any->promise.get_future();
+
+    for (size_t i = 0; i < futures.size(); ++i)
+    {
+        futures[i].on_ready(nullptr, [any, i](Future<T> f) {
+            if (any->is_done.exchange(true, std::memory_order_acq_rel))
+                return; // another future was first
+
+            try
+            {
+                if constexpr (std::is_void_v<T>)
+                {
+                    f.get();
+                    any->promise.set_value(i);
+                }
+                else
+                    any->promise.set_value(i, f.get());
+            }
+            catch (...)
+            {
+                any->promise.set_exception(std::current_exception());
+            }
+        });
+    }
+
+    return f_result;
+}
+
+#endif // FUTURE_HPP
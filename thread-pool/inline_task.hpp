@@ -0,0 +1,173 @@
+#ifndef INLINE_TASK_HPP
+#define INLINE_TASK_HPP
+
+#include "recycling_allocator.hpp"
+
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+// move-only void() callable with a 64-byte inline buffer
+// - closures that fit (e.g. a promise + a few captures) are stored without any allocation
+class InlineTask
+{
+public:
+    static constexpr size_t buffer_size = 64;
+
+private:
+    struct VTable
+    {
+        void (*invoke)(void* storage);
+        void (*move)(void* dest, void* src) noexcept; // move-constructs into dest & destroys src
+        void (*destroy)(void* storage) noexcept;
+    };
+
+    template <typename F>
+    static constexpr bool is_stored_inline = sizeof(F) <= buffer_size
+        && alignof(F) <= alignof(std::max_align_t)
+        && std::is_nothrow_move_constructible_v<F>;
+
+    template <typename F>
+    static F* inline_target(void* storage)
+    {
+        return std::launder(static_cast<F*>(storage));
+    }
+
+    template <typename F>
+    static F*& heap_target(void* storage)
+    {
+        return *std::launder(static_cast<F**>(storage));
+    }
+
+    template <typename F>
+    static constexpr VTable inline_vtable{
+        [](void* storage) { std::invoke(*inline_target<F>(storage)); },
+        [](void* dest, void* src) noexcept {
+            std::construct_at(static_cast<F*>(dest), std::move(*inline_target<F>(src)));
+            std::destroy_at(inline_target<F>(src));
+        },
+        [](void* storage) noexcept { std::destroy_at(inline_target<F>(storage)); }};
+
+    template <typename F>
+    static constexpr VTable heap_vtable{
+        [](void* storage) { std::invoke(*heap_target<F>(storage)); },
+        [](void* dest, void* src) noexcept { ::new (dest) F*(heap_target<F>(src)); },
+        [](void* storage) noexcept { delete heap_target<F>(storage); }};
+
+    alignas(std::max_align_t) std::byte buffer_[buffer_size];
+    const VTable* vtable_ = nullptr;
+
+public:
+    InlineTask() = default;
+
+    InlineTask(std::nullptr_t) noexcept
+    {
+    }
+
+    template <typename TFunction>
+        requires(!std::is_same_v<std::decay_t<TFunction>, InlineTask> && std::is_invocable_v<std::decay_t<TFunction>&>)
+    InlineTask(TFunction&& f)
+    {
+        using F = std::decay_t<TFunction>;
+
+        if constexpr (is_stored_inline<F>)
+        {
+            std::construct_at(reinterpret_cast<F*>(buffer_), std::forward<TFunction>(f));
+            vtable_ = &inline_vtable<F>;
+        }
+        else
+        {
+            ::new (buffer_) F*(new F(std::forward<TFunction>(f)));
+            vtable_ = &heap_vtable<F>;
+        }
+    }
+
+    InlineTask(InlineTask&& other) noexcept
+        : vtable_{std::exchange(other.vtable_, nullptr)}
+    {
+        if (vtable_)
+            vtable_->move(buffer_, other.buffer_);
+    }
+
+    InlineTask& operator=(InlineTask&& other) noexcept
+    {
+        if (this != &other)
+        {
+            reset();
+            if (other.vtable_)
+            {
+                other.vtable_->move(buffer_, other.buffer_);
+                vtable_ = std::exchange(other.vtable_, nullptr);
+            }
+        }
+        return *this;
+    }
+
+    InlineTask& operator=(std::nullptr_t) noexcept
+    {
+        reset();
+        return *this;
+    }
+
+    InlineTask(const InlineTask&) = delete;
+    InlineTask& operator=(const InlineTask&) = delete;
+
+    ~InlineTask()
+    {
+        reset();
+    }
+
+    explicit operator bool() const noexcept
+    {
+        return vtable_ != nullptr;
+    }
+
+    void operator()()
+    {
+        vtable_->invoke(buffer_);
+    }
+
+private:
+    void reset() noexcept
+    {
+        if (vtable_)
+            std::exchange(vtable_, nullptr)->destroy(buffer_);
+    }
+};
+
+// wraps f in a task that fulfills a promise - the shared state of the promise
+// comes from RecyclingAllocator, the closure is stored inline in the task
+template <typename TFunction>
+auto make_task_with_future(TFunction&& f)
+{
+    using TResult = std::invoke_result_t<std::decay_t<TFunction>&>;
+
+    std::promise<TResult> promise{std::allocator_arg, RecyclingAllocator<TResult>{}};
+    std::future<TResult> f_result = promise.get_future();
+
+    InlineTask task{[promise = std::move(promise), f = std::forward<TFunction>(f)]() mutable {
+        try
+        {
+            if constexpr (std::is_void_v<TResult>)
+            {
+                std::invoke(f);
+                promise.set_value();
+            }
+            else
+                promise.set_value(std::invoke(f));
+        }
+        catch (...)
+        {
+            promise.set_exception(std::current_exception());
+        }
+    }};
+
+    return std::pair{std::move(task), std::move(f_result)};
+}
+
+#endif // INLINE_TASK_HPP
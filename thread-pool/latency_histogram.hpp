@@ -0,0 +1,153 @@
+#ifndef LATENCY_HISTOGRAM_HPP
+#define LATENCY_HISTOGRAM_HPP
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+// histogram of latencies in microseconds with HDR-style buckets - every power-of-two range [2^e, 2^(e+1))
+// is split into 32 sub-buckets of equal width, latencies below 32us get a bucket each
+// - a percentile is off by at most 1/32 (~3%) of its value; latencies from 2^40us up share the last bucket
+class LatencyHistogram
+{
+public:
+    static constexpr size_t sub_bucket_bits = 5;
+    static constexpr size_t sub_buckets = size_t{1} << sub_bucket_bits;
+    static constexpr size_t max_exponent = 39;
+    static constexpr size_t no_of_buckets = (max_exponent - sub_bucket_bits + 2) * sub_buckets;
+
+private:
+    std::array<std::uint64_t, no_of_buckets> buckets_{};
+    std::uint64_t count_ = 0;
+    std::chrono::microseconds total_{0};
+    std::chrono::microseconds max_{0};
+
+    friend class AtomicLatencyHistogram;
+
+public:
+    static size_t bucket_of(std::chrono::microseconds latency)
+    {
+        const auto us = static_cast<std::uint64_t>(std::max<std::int64_t>(latency.count(), 0));
+        if (us < sub_buckets)
+            return us;
+
+        const size_t exponent = std::bit_width(us) - 1;
+        if (exponent > max_exponent)
+            return no_of_buckets - 1;
+
+        const size_t sub_bucket = (us >> (exponent - sub_bucket_bits)) - sub_buckets;
+        return (exponent - sub_bucket_bits + 1) * sub_buckets + sub_bucket;
+    }
+
+    // smallest latency of bucket i
+    static std::uint64_t bucket_lower(size_t i)
+    {
+        const size_t group = i / sub_buckets; // 0 - exact buckets, g - exponent g + sub_bucket_bits - 1
+        if (group == 0)
+            return i;
+        return (sub_buckets + i % sub_buckets) << (group - 1);
+    }
+
+    // number of latencies (in microseconds) held by bucket i
+    static std::uint64_t bucket_width(size_t i)
+    {
+        const size_t group = i / sub_buckets;
+        return group == 0 ? 1 : std::uint64_t{1} << (group - 1);
+    }
+
+    void add(std::chrono::microseconds latency)
+    {
+        ++buckets_[bucket_of(latency)];
+        ++count_;
+        total_ += latency;
+        max_ = std::max(max_, latency);
+    }
+
+    LatencyHistogram& operator+=(const LatencyHistogram& other)
+    {
+        for (size_t i = 0; i < no_of_buckets; ++i)
+            buckets_[i] += other.buckets_[i];
+        count_ += other.count_;
+        total_ += other.total_;
+        max_ = std::max(max_, other.max_);
+        return *this;
+    }
+
+    std::uint64_t count() const
+    {
+        return count_;
+    }
+
+    std::chrono::microseconds mean() const
+    {
+        return count_ ? total_ / static_cast<std::int64_t>(count_) : std::chrono::microseconds{0};
+    }
+
+    std::chrono::microseconds max() const
+    {
+        return max_;
+    }
+
+    // q-th quantile (q in [0, 1]) - interpolated linearly within the bucket that holds it
+    std::chrono::microseconds percentile(double q) const
+    {
+        if (count_ == 0)
+            return std::chrono::microseconds{0};
+
+        const auto rank = static_cast<std::uint64_t>(q * static_cast<double>(count_ - 1)) + 1;
+        std::uint64_t seen = 0;
+        for (size_t i = 0; i < no_of_buckets; ++i)
+        {
+            if (seen + buckets_[i] >= rank)
+            {
+                const auto offset = (bucket_width(i) - 1) * (rank - seen) / buckets_[i];
+                return std::min(std::chrono::microseconds{bucket_lower(i) + offset}, max_);
+            }
+            seen += buckets_[i];
+        }
+        return max_;
+    }
+};
+
+// same buckets updated by a single writer thread with relaxed loads & stores (no read-modify-write),
+// readers take a snapshot at any time - counts of a snapshot may lag by the latency being recorded
+class AtomicLatencyHistogram
+{
+    std::array<std::atomic<std::uint64_t>, LatencyHistogram::no_of_buckets> buckets_{};
+    std::atomic<std::uint64_t> count_{0};
+    std::atomic<std::int64_t> total_us_{0};
+    std::atomic<std::int64_t> max_us_{0};
+
+    template <typename T>
+    static void increment(std::atomic<T>& counter, T value) // single writer
+    {
+        counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+    }
+
+public:
+    void add(std::chrono::microseconds latency) // owner thread only
+    {
+        increment(buckets_[LatencyHistogram::bucket_of(latency)], std::uint64_t{1});
+        increment(count_, std::uint64_t{1});
+        increment(total_us_, static_cast<std::int64_t>(latency.count()));
+        if (latency.count() > max_us_.load(std::memory_order_relaxed))
+            max_us_.store(latency.count(), std::memory_order_relaxed);
+    }
+
+    LatencyHistogram snapshot() const // any thread
+    {
+        LatencyHistogram result;
+        for (size_t i = 0; i < LatencyHistogram::no_of_buckets; ++i)
+            result.buckets_[i] = buckets_[i].load(std::memory_order_relaxed);
+        result.count_ = count_.load(std::memory_order_relaxed);
+        result.total_ = std::chrono::microseconds{total_us_.load(std::memory_order_relaxed)};
+        result.max_ = std::chrono::microseconds{max_us_.load(std::memory_order_relaxed)};
+        return result;
+    }
+};
+
+#endif // LATENCY_HISTOGRAM_HPP
@@ -1,15 +1,33 @@
+#include "allocation_counter.hpp" // allocations_count - used by benchmark_submit_paths()
+#include "coroutine_task.hpp"
+#include "elastic_thread_pool.hpp"
+#include "future.hpp"
+#include "inline_task.hpp"
+#include "pool_metrics.hpp"
+#include "priority_task_queue.hpp"
 #include "thread_safe_queue.hpp"
+#include "work_stealing_thread_pool.hpp"
 
+#include <array>
+#include <atomic>
 #include <cassert>
 #include <chrono>
+#include <cstdint>
 #include <functional>
 #include <iostream>
+#include <iterator>
 #include <string>
 #include <thread>
 #include <vector>
 #include <future>
 #include <syncstream>
 #include <random>
+#include <latch>
+#include <memory>
+#include <mutex>
+#include <numeric>
+#include <ranges>
+#include <stdexcept>
 
 using namespace std::literals;
 
@@ -49,19 +67,25 @@ void background_work(size_t id, const std::string& text, std::chrono::millisecon
     sync_cout() << "bw#" << id << " is finished..." << std::endl;
 }
 
-using Task = std::move_only_function<void()>;
+using Task = InlineTask; // 64-byte inline buffer - no allocation for small closures
+using TaskQueue = ThreadSafeQueue<Task, RecyclingBlockStorage<Task>>; // no allocations under the queue lock in steady state
 
 inline namespace ver_1
 {
-    class ThreadPool
+    class ThreadPool : public Executor
     {
     public:
-        ThreadPool(size_t size)
+        // bounded queue_capacity makes submit() block when producers outrun the workers
+        // aging_step - a waiting task is promoted by one priority level per aging_step
+        ThreadPool(size_t size, size_t queue_capacity = PriorityTaskQueue<Task>::unbounded,
+            std::chrono::steady_clock::duration aging_step = std::chrono::milliseconds{100})
+            : tasks_{queue_capacity, aging_step}
+            , counters_{std::make_unique<WorkerCounters[]>(size)}
         {
             threads_.reserve(size);
             for (size_t i = 0; i < size; ++i)
-                threads_.push_back(std::jthread{[this] {
-                    run();
+                threads_.push_back(std::jthread{[this, i] {
+                    run(i);
                 }});
         }
 
@@ -72,46 +96,208 @@ inline namespace ver_1
         ThreadPool& operator=(ThreadPool&&) = delete;
 
         ~ThreadPool()
-        {        
-            for (size_t i = 0; i < threads_.size(); ++i)
-            {
-                auto kill_task = [this] {
-                    is_done_ = true;
-                };
-                tasks_.push(std::move(kill_task));
-            }
+        {
+            shutdown();
+        }
+
+        // graceful - waits until all queued tasks (and continuations they schedule) are done,
+        // then stops the workers; must not be called from a task of this pool
+        void shutdown()
+        {
+            std::lock_guard lk{mtx_shutdown_};
+            if (is_shut_down_)
+                return;
+
+            tasks_.wait_done();
+            stop_workers();
+        }
+
+        // immediate - workers finish only the tasks they are running, queued tasks are returned
+        // (destroying them breaks their promises); continuations scheduled later are dropped
+        std::vector<Task> shutdown_now()
+        {
+            std::lock_guard lk{mtx_shutdown_};
+            if (is_shut_down_)
+                return {};
+
+            tasks_.close();
+            std::vector<Task> unexecuted = tasks_.take_all();
+            stop_workers();
+
+            return unexecuted;
+        }
+
+        // barrier - returns when no task is queued or running; the pool keeps working afterwards
+        void wait_idle() const
+        {
+            tasks_.wait_done();
         }
 
         template <typename TTask>
-        auto submit(TTask&& task)
+        auto submit(TTask&& task, Priority priority = Priority::normal)
         {
-            using TResult = decltype(task());
+            using TResult = std::invoke_result_t<std::decay_t<TTask>&>;
 
             // work-around for std::function as Task
             // auto pt = std::make_shared<std::packaged_task<TResult()>>(std::forward<TTask>(task));
             // std::future<TResult> f_result = pt->get_future();
             // tasks_.push([pt] { (*pt)(); });
 
-            std::packaged_task<TResult()> pt(std::forward<TTask>(task));
-            std::future<TResult> f_result = pt.get_future();
-            tasks_.push(std::move(pt));
+            // shared state comes from this thread's slab of the pool, the closure is stored inline in the Task
+            // continuations attached with then() are scheduled on this pool
+            Promise<TResult> promise{&shared_states_, this};
+            Future<TResult> f_result = promise.get_future();
+            tasks_.push([promise = std::move(promise), task = std::forward<TTask>(task)]() mutable {
+                promise.set_result_of(task);
+            }, priority);
 
             return f_result;
         }
 
+        // per-priority queue depth and wait times (from push to start of execution)
+        std::array<PriorityQueueStats, priority_levels> queue_stats() const
+        {
+            return tasks_.stats();
+        }
+
+        // snapshot of queue & per-worker counters - workers keep running while it is taken
+        ThreadPoolStats stats() const
+        {
+            return ThreadPoolStats::collect(counters_.get(), threads_.size(), tasks_.stats());
+        }
+
+        // continuations - never waits for room in a bounded queue, as it is called by the workers
+        void execute(Task task) override
+        {
+            try
+            {
+                tasks_.force_push(std::move(task));
+            }
+            catch (const std::runtime_error&)
+            {
+                // pool was shut down - dropped task breaks its promise
+            }
+        }
+
+        // calls f(i) for every i in [begin, end) - chunks of grain indexes are enqueued with one queue operation
+        // grain == 0 - about 4 chunks per worker; the future is ready when all chunks are done
+        template <std::integral TIndex, typename TFunction>
+        Future<void> parallel_for(TIndex begin, TIndex end, size_t grain, TFunction f)
+        {
+            const size_t count = end > begin ? static_cast<size_t>(end - begin) : 0;
+            if (grain == 0)
+                grain = std::max<size_t>(1, count / (threads_.size() * 4));
+            const size_t no_of_chunks = (count + grain - 1) / grain;
+
+            auto bulk = std::make_shared<BulkState<TFunction>>(no_of_chunks, std::move(f), &shared_states_, this);
+            Future<void> f_done = bulk->promise.get_future();
+
+            if (no_of_chunks == 0)
+            {
+                bulk->promise.set_value();
+                return f_done;
+            }
+
+            std::vector<Task> chunks;
+            chunks.reserve(no_of_chunks);
+            for (size_t offset = 0; offset < count; offset += grain)
+            {
+                const TIndex first = static_cast<TIndex>(begin + offset);
+                const TIndex last = static_cast<TIndex>(begin + std::min(offset + grain, count));
+                chunks.emplace_back([bulk, first, last] { bulk->run(first, last); });
+            }
+            tasks_.push_range(std::ranges::subrange{std::make_move_iterator(chunks.begin()), std::make_move_iterator(chunks.end())});
+
+            return f_done;
+        }
+
+        // calls f(item) for every item of range - range must stay alive until the future is ready
+        template <std::ranges::random_access_range TRange, typename TFunction>
+        Future<void> submit_bulk(TRange&& range, TFunction f, size_t grain = 0)
+        {
+            auto first = std::ranges::begin(range);
+            return parallel_for(size_t{0}, static_cast<size_t>(std::ranges::size(range)), grain, [first, f = std::move(f)](size_t i) mutable {
+                f(first[i]);
+            });
+        }
+
     private:
-        ThreadSafeQueue<Task> tasks_;
+        // shared by all chunks of one parallel_for - the last finished chunk fulfills the promise
+        template <typename TFunction>
+        struct BulkState
+        {
+            std::atomic<size_t> remaining_chunks;
+            TFunction f;
+            Promise<void> promise;
+            std::atomic<bool> has_failed{false};
+            std::mutex mtx_exception;
+            std::exception_ptr exception;
+
+            BulkState(size_t no_of_chunks, TFunction f, SharedStateSlabs* slabs, Executor* pool)
+                : remaining_chunks{no_of_chunks}
+                , f{std::move(f)}
+                , promise{slabs, pool}
+            {
+            }
+
+            template <typename TIndex>
+            void run(TIndex first, TIndex last)
+            {
+                try
+                {
+                    for (TIndex i = first; i != last && !has_failed.load(std::memory_order_relaxed); ++i)
+                        f(i);
+                }
+                catch (...)
+                {
+                    std::lock_guard lk{mtx_exception};
+                    if (!exception)
+                        exception = std::current_exception();
+                    has_failed = true;
+                }
+
+                if (remaining_chunks.fetch_sub(1, std::memory_order_acq_rel) == 1)
+                {
+                    if (exception)
+                        promise.set_exception(exception);
+                    else
+                        promise.set_value();
+                }
+            }
+        };
+
+        SharedStateSlabs shared_states_; // outlives queued tasks - declared first
+        PriorityTaskQueue<Task> tasks_;
+        std::unique_ptr<WorkerCounters[]> counters_;
         std::vector<std::jthread> threads_;
-        std::atomic<bool> is_done_ = false;
+        std::mutex mtx_shutdown_;
+        bool is_shut_down_ = false;
 
-        void run()
+        void stop_workers() // under mtx_shutdown_
+        {
+            tasks_.close(); // workers exit when the queue is drained
+            for (auto& thd : threads_)
+                thd.join();
+            is_shut_down_ = true;
+        }
+
+        void run(size_t index)
         {
-            while (!is_done_)
+            WorkerCounters& counters = counters_[index];
+
+            Task task;
+            while (true)
             {
-                Task task;
-                tasks_.pop(task);
+                const auto idle_start = std::chrono::steady_clock::now();
+                if (!tasks_.pop(task)) // closed & drained
+                    return;
+                const auto run_start = std::chrono::steady_clock::now();
 
                 task(); // running task in this thread
+                task = nullptr;
+
+                counters.record(run_start - idle_start, std::chrono::steady_clock::now() - run_start);
+                tasks_.task_done();
             }
         }
     };
@@ -122,7 +308,9 @@ namespace ver_2
     class ThreadPool
     {
     public:
-        ThreadPool(size_t size)
+        // bounded queue_capacity makes submit() block when producers outrun the workers
+        ThreadPool(size_t size, size_t queue_capacity = TaskQueue::unbounded)
+            : tasks_{queue_capacity}
         {
             threads_.reserve(size);
             for (size_t i = 0; i < size; ++i)
@@ -138,12 +326,8 @@ namespace ver_2
         ThreadPool& operator=(ThreadPool&&) = delete;
 
         ~ThreadPool()
-        {            
-            for (size_t i = 0; i < threads_.size(); ++i)
-            {   
-                Task STOP;
-                tasks_.push(std::move(STOP)); // poisoning pill
-            }
+        {
+            tasks_.close(); // wakes all workers at once - they exit after the queue is drained
         }
 
         void submit(Task task)
@@ -154,27 +338,400 @@ namespace ver_2
             tasks_.push(std::move(task));
         }
 
+        // co_await pool.schedule() - the coroutine continues on a worker of the pool
+        Coro::ScheduleOn<ThreadPool> schedule()
+        {
+            return Coro::ScheduleOn<ThreadPool>{*this};
+        }
+
     private:
-        ThreadSafeQueue<Task> tasks_;
+        TaskQueue tasks_;
         std::vector<std::jthread> threads_;
-        inline static const Task STOP;
 
         void run()
         {
-            while (true)
+            Task task;
+            while (tasks_.pop(task)) // false when the queue is closed & drained
             {
-                Task task;
-                tasks_.pop(task);
-
-                if (!task)
-                    break; // if poisonning pill
-
                 task(); // running task in this thread
             }
         }
     };
 } // namespace ver_1
 
+template <typename TThreadPool>
+void benchmark_thread_pool(const std::string& name)
+{
+    constexpr int no_of_tasks = 1'000'000;
+    constexpr int no_of_subtasks = 100;
+
+    const auto no_of_threads = std::max(std::thread::hardware_concurrency(), 1u);
+    std::atomic<int> counter{};
+
+    {
+        TThreadPool thd_pool(no_of_threads);
+
+        const auto start = std::chrono::high_resolution_clock::now();
+
+        std::latch all_done{no_of_tasks};
+        for (int i = 0; i < no_of_tasks; ++i)
+            thd_pool.submit([&] { counter.fetch_add(1, std::memory_order_relaxed); all_done.count_down(); });
+        all_done.wait();
+
+        const auto end = std::chrono::high_resolution_clock::now();
+        sync_cout() << name << " - " << no_of_tasks << " external submits: "
+                    << std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count() << "ms" << std::endl;
+    }
+
+    {
+        TThreadPool thd_pool(no_of_threads);
+
+        const auto start = std::chrono::high_resolution_clock::now();
+
+        // tasks submitted from inside workers - local deques for the work-stealing pool
+        std::latch all_done{no_of_tasks};
+        for (int i = 0; i < no_of_tasks / no_of_subtasks; ++i)
+            thd_pool.submit([&] {
+                for (int j = 0; j < no_of_subtasks; ++j)
+                    thd_pool.submit([&] { counter.fetch_add(1, std::memory_order_relaxed); all_done.count_down(); });
+            });
+        all_done.wait();
+
+        const auto end = std::chrono::high_resolution_clock::now();
+        sync_cout() << name << " - " << no_of_tasks << " nested submits: "
+                    << std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count() << "ms" << std::endl;
+    }
+}
+
+// allocations & latency of creating a task with a future and passing it to a worker
+template <typename TTask, typename TMakeTask>
+void benchmark_submit_path(const std::string& name, TMakeTask make_task)
+{
+    constexpr int no_of_batches = 1'000;
+    constexpr int batch_size = 100;
+
+    ThreadSafeQueue<TTask, RecyclingBlockStorage<TTask>> tasks;
+    std::jthread worker{[&tasks] {
+        TTask task;
+        while (tasks.pop(task))
+        {
+            task();
+            task = nullptr;
+        }
+    }};
+
+    std::vector<decltype(make_task([] { return 0; }).second)> futures;
+    futures.reserve(batch_size);
+
+    for (int round = 0; round < 2; ++round) // first round warms up caches & recycled blocks
+    {
+        const auto allocations_before = allocations_count.load();
+        const auto start = std::chrono::high_resolution_clock::now();
+
+        for (int batch = 0; batch < no_of_batches; ++batch)
+        {
+            for (int i = 0; i < batch_size; ++i)
+            {
+                auto [task, f] = make_task([i] { return i * i; });
+                tasks.push(std::move(task));
+                futures.push_back(std::move(f));
+            }
+
+            for (auto& f : futures)
+                f.get();
+            futures.clear();
+        }
+
+        const auto end = std::chrono::high_resolution_clock::now();
+        const auto allocations = allocations_count.load() - allocations_before;
+
+        if (round == 1)
+            sync_cout() << name << " - allocations per submit: " << static_cast<double>(allocations) / (no_of_batches * batch_size)
+                        << "; latency per submit: " << std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count() / (no_of_batches * batch_size) << "ns" << std::endl;
+    }
+
+    tasks.close();
+}
+
+void benchmark_submit_paths()
+{
+    sync_cout() << "\n------------------------------------\n";
+
+    benchmark_submit_path<std::move_only_function<void()>>("packaged_task + move_only_function", [](auto f) {
+        std::packaged_task<int()> pt{std::move(f)};
+        auto f_result = pt.get_future();
+        return std::pair{std::move_only_function<void()>{std::move(pt)}, std::move(f_result)};
+    });
+
+    benchmark_submit_path<InlineTask>("recycled promise + InlineTask", [](auto f) {
+        return make_task_with_future(std::move(f));
+    });
+
+    SharedStateSlabs shared_states;
+    benchmark_submit_path<InlineTask>("slab Promise/Future + InlineTask", [&shared_states](auto f) {
+        Promise<int> promise{&shared_states};
+        auto f_result = promise.get_future();
+        return std::pair{InlineTask{[promise = std::move(promise), f = std::move(f)]() mutable { promise.set_result_of(f); }}, std::move(f_result)};
+    });
+}
+
+void benchmark_parallel_for()
+{
+    constexpr size_t no_of_items = 1'000'000;
+
+    sync_cout() << "\n------------------------------------\n";
+
+    std::vector<uint64_t> squares(no_of_items);
+    ThreadPool thd_pool(std::max(std::thread::hardware_concurrency(), 1u));
+
+    {
+        const auto start = std::chrono::high_resolution_clock::now();
+
+        std::vector<Future<void>> futures;
+        futures.reserve(no_of_items);
+        for (size_t i = 0; i < no_of_items; ++i)
+            futures.push_back(thd_pool.submit([&squares, i] { squares[i] = i * i; }));
+        for (auto& f : futures)
+            f.get();
+
+        const auto end = std::chrono::high_resolution_clock::now();
+        sync_cout() << "submit per item: " << std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count() << "ms" << std::endl;
+    }
+
+    {
+        const auto start = std::chrono::high_resolution_clock::now();
+
+        thd_pool.parallel_for(size_t{0}, no_of_items, 0, [&squares](size_t i) { squares[i] = i * i; }).get();
+
+        const auto end = std::chrono::high_resolution_clock::now();
+        sync_cout() << "parallel_for: " << std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count() << "ms" << std::endl;
+    }
+
+    {
+        const auto start = std::chrono::high_resolution_clock::now();
+
+        thd_pool.submit_bulk(squares, [](uint64_t& item) { item *= 2; }).get();
+
+        const auto end = std::chrono::high_resolution_clock::now();
+        sync_cout() << "submit_bulk: " << std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count() << "ms" << std::endl;
+    }
+}
+
+// latency of requests submitted during a burst of batch jobs - with the same priority they queue behind the burst
+void benchmark_priorities()
+{
+    constexpr int no_of_batch_jobs = 10'000;
+    constexpr int no_of_requests = 200;
+
+    auto busy_work = [] {
+        const auto start = std::chrono::steady_clock::now();
+        while (std::chrono::steady_clock::now() - start < 10us)
+            continue;
+    };
+
+    auto run = [&](Priority request_priority) {
+        ThreadPool thd_pool(std::max(std::thread::hardware_concurrency(), 1u));
+
+        std::vector<Future<void>> f_done;
+        f_done.reserve(no_of_batch_jobs + no_of_requests);
+
+        for (int i = 0; i < no_of_batch_jobs; ++i)
+            f_done.push_back(thd_pool.submit(busy_work, Priority::low));
+
+        for (int i = 0; i < no_of_requests; ++i)
+        {
+            f_done.push_back(thd_pool.submit(busy_work, request_priority));
+            std::this_thread::sleep_for(250us);
+        }
+
+        when_all(std::move(f_done)).get();
+
+        sync_cout() << "requests with " << to_string(request_priority) << " priority:\n";
+        const auto stats = thd_pool.queue_stats();
+        for (size_t level = 0; level < priority_levels; ++level)
+        {
+            const auto& s = stats[level];
+            if (s.popped == 0)
+                continue;
+            sync_cout() << "  " << to_string(static_cast<Priority>(level)) << " - tasks: " << s.popped
+                        << ", wait mean: " << s.mean_wait.count() << "us, p50: " << s.p50_wait.count()
+                        << "us, p99: " << s.p99_wait.count() << "us, max: " << s.max_wait.count() << "us" << std::endl;
+        }
+    };
+
+    sync_cout() << "\n------------------------------------\n";
+    run(Priority::low);
+    run(Priority::high);
+}
+
+// stats dumped periodically while the pool works, then a final snapshot as JSON
+void benchmark_pool_stats()
+{
+    sync_cout() << "\n------------------------------------\n";
+
+    ThreadPool thd_pool(std::max(std::thread::hardware_concurrency(), 1u));
+    {
+        StatsReporter reporter{thd_pool, std::cout, 100ms};
+
+        std::vector<Future<void>> f_done;
+        for (int i = 0; i < 1'000; ++i)
+            f_done.push_back(thd_pool.submit([i] { std::this_thread::sleep_for(std::chrono::microseconds(i % 7 == 0 ? 2'000 : 100)); }));
+        when_all(std::move(f_done)).get();
+    }
+
+    write_json(std::cout, thd_pool.stats());
+}
+
+// blocking (I/O-like) tasks - a fixed pool runs them hardware_concurrency() at a time, an elastic pool grows
+void benchmark_elastic_pool()
+{
+    constexpr int no_of_tasks = 64;
+
+    const auto no_of_threads = std::max(std::thread::hardware_concurrency(), 1u);
+    auto blocking_io = [] { std::this_thread::sleep_for(50ms); };
+
+    sync_cout() << "\n------------------------------------\n";
+
+    {
+        const auto start = std::chrono::high_resolution_clock::now();
+        {
+            ThreadPool thd_pool(no_of_threads);
+            for (int i = 0; i < no_of_tasks; ++i)
+                thd_pool.submit(blocking_io);
+        }
+        const auto end = std::chrono::high_resolution_clock::now();
+        sync_cout() << "fixed pool of " << no_of_threads << " - elapsed time: "
+                    << std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count() << "ms" << std::endl;
+    }
+
+    {
+        Elastic::ThreadPool thd_pool(no_of_threads, no_of_tasks, 1ms, 200ms);
+
+        const auto start = std::chrono::high_resolution_clock::now();
+        std::vector<Future<void>> f_done;
+        for (int i = 0; i < no_of_tasks; ++i)
+            f_done.push_back(thd_pool.submit(blocking_io));
+        when_all(std::move(f_done)).get();
+        const auto end = std::chrono::high_resolution_clock::now();
+
+        sync_cout() << "elastic pool grew to " << thd_pool.size() << " - elapsed time: "
+                    << std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count() << "ms" << std::endl;
+
+        std::this_thread::sleep_for(500ms);
+        sync_cout() << "elastic pool after idle timeout: " << thd_pool.size() << std::endl;
+    }
+}
+
+void benchmark_thread_pools()
+{
+    sync_cout() << "\n------------------------------------\n";
+    benchmark_thread_pool<ver_1::ThreadPool>("single queue");
+    benchmark_thread_pool<WorkStealing::ThreadPool>("work stealing");
+}
+
+// DAG without blocked threads - every edge is a continuation scheduled on the pool
+void continuations_demo()
+{
+    sync_cout() << "\n------------------------------------\n";
+
+    ThreadPool thd_pool(std::max(std::thread::hardware_concurrency(), 1u));
+
+    Future<std::string> f_text = thd_pool.submit([] { return std::string{"continuations"}; })
+                                     .then([](std::string text) { return text + " on the pool"; });
+
+    std::vector<Future<int>> f_squares;
+    for (int i = 1; i <= 8; ++i)
+        f_squares.push_back(thd_pool.submit([i] { return i * i; }).then([](int square) { return square + 1; }));
+
+    Future<int> f_sum = when_all(std::move(f_squares)).then([](std::vector<int> squares) {
+        return std::accumulate(squares.begin(), squares.end(), 0);
+    });
+
+    std::vector<Future<int>> f_racers;
+    f_racers.push_back(thd_pool.submit([] { std::this_thread::sleep_for(100ms); return 1; }));
+    f_racers.push_back(thd_pool.submit([] { return 2; }));
+    Future<std::pair<size_t, int>> f_first = when_any(std::move(f_racers));
+
+    Future<int> f_failed = thd_pool.submit([]() -> int { throw std::runtime_error("failed step"); })
+                               .then([](int value) { return value * 2; }); // skipped - exception propagates
+
+    // a worker completing a task schedules its continuation on the full queue of its own pool - it must not wait for room
+    ThreadPool bounded_pool(1, 1);
+    std::vector<Future<int>> f_incremented;
+    for (int i = 0; i < 100; ++i)
+        f_incremented.push_back(bounded_pool.submit([i] { return i; }).then([](int value) { return value + 1; }));
+    Future<int> f_bounded_sum = when_all(std::move(f_incremented)).then([](std::vector<int> values) {
+        return std::accumulate(values.begin(), values.end(), 0);
+    });
+
+    sync_cout() << f_text.get() << std::endl;
+    sync_cout() << "sum of squares + 1: " << f_sum.get() << std::endl;
+    sync_cout() << "continuations on a bounded pool: " << f_bounded_sum.get() << std::endl;
+    sync_cout() << "first racer: " << f_first.get().second << std::endl;
+
+    try
+    {
+        f_failed.get();
+    }
+    catch (const std::runtime_error& e)
+    {
+        sync_cout() << "propagated: " << e.what() << std::endl;
+    }
+}
+
+// calculate_square without blocking a thread - the simulated I/O suspends the coroutine
+Coro::Task<int> async_calculate_square(Coro::Timer<ver_2::ThreadPool>& timer, int x)
+{
+    co_await timer.sleep_for(std::chrono::milliseconds(100 + x % 400));
+
+    if (x % 3 == 0)
+        throw std::runtime_error("Error#3");
+
+    co_return x * x;
+}
+
+Coro::Task<int> sum_of_squares(ver_2::ThreadPool& thd_pool, Coro::Timer<ver_2::ThreadPool>& timer, int x)
+{
+    int sum = 0;
+    for (int i = x; i < x + 2; ++i)
+    {
+        try
+        {
+            sum += co_await async_calculate_square(timer, i);
+        }
+        catch (const std::runtime_error&)
+        {
+        }
+        co_await thd_pool.schedule(); // yields to other coroutines waiting in the queue
+    }
+    co_return sum;
+}
+
+void coroutines_demo()
+{
+    sync_cout() << "\n------------------------------------\n";
+
+    constexpr int no_of_jobs = 10'000;
+
+    ver_2::ThreadPool thd_pool(std::max(std::thread::hardware_concurrency(), 1u));
+    Coro::Timer timer{thd_pool};
+
+    const auto start = std::chrono::high_resolution_clock::now();
+
+    std::vector<Future<int>> f_sums;
+    f_sums.reserve(no_of_jobs);
+    for (int i = 0; i < no_of_jobs; ++i)
+        f_sums.push_back(Coro::spawn(thd_pool, sum_of_squares(thd_pool, timer, i)));
+
+    const std::vector<int> sums = when_all(std::move(f_sums)).get();
+    const auto total = std::accumulate(sums.begin(), sums.end(), std::int64_t{0});
+
+    const auto end = std::chrono::high_resolution_clock::now();
+    const auto elapsed_time = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
+
+    sync_cout() << no_of_jobs << " coroutines on " << std::max(std::thread::hardware_concurrency(), 1u)
+                << " threads - total: " << total << " - elapsed time: " << elapsed_time << "ms" << std::endl;
+}
 
 int main()
 {
@@ -186,11 +743,11 @@ int main()
 
         thd_pool.submit([text] { background_work(1, text, 250ms); });
 
-        std::vector<std::tuple<int, std::future<int>>> f_squares;
+        std::vector<std::tuple<int, Future<int>>> f_squares;
 
         for (int i = 1; i < 20; ++i)
         {
-            std::future<int> f_square = thd_pool.submit([i] { return calculate_square(i); });
+            Future<int> f_square = thd_pool.submit([i] { return calculate_square(i); });
             f_squares.emplace_back(i, std::move(f_square));
         }
 
@@ -207,5 +764,14 @@ int main()
         }
     }
 
+    continuations_demo();
+    coroutines_demo();
+    benchmark_submit_paths();
+    benchmark_parallel_for();
+    benchmark_priorities();
+    benchmark_pool_stats();
+    benchmark_elastic_pool();
+    benchmark_thread_pools();
+
     sync_cout() << "Main thread ends..." << std::endl;
 }
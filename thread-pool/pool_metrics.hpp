@@ -0,0 +1,175 @@
+#ifndef POOL_METRICS_HPP
+#define POOL_METRICS_HPP
+
+#include "cache_line.hpp"
+#include "latency_histogram.hpp"
+#include "priority_task_queue.hpp"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <ostream>
+#include <stop_token>
+#include <thread>
+#include <vector>
+
+// counters of one worker - written only by the worker (relaxed, no read-modify-write), read by stats()
+struct alignas(Hardware::cache_line_size) WorkerCounters
+{
+    std::atomic<std::uint64_t> tasks{0};
+    std::atomic<std::int64_t> busy_ns{0};
+    std::atomic<std::int64_t> idle_ns{0}; // waiting in pop
+    AtomicLatencyHistogram run_times;
+
+    void record(std::chrono::nanoseconds idle_time, std::chrono::nanoseconds run_time) // owner thread only
+    {
+        tasks.store(tasks.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        busy_ns.store(busy_ns.load(std::memory_order_relaxed) + run_time.count(), std::memory_order_relaxed);
+        idle_ns.store(idle_ns.load(std::memory_order_relaxed) + idle_time.count(), std::memory_order_relaxed);
+        run_times.add(std::chrono::duration_cast<std::chrono::microseconds>(run_time));
+    }
+};
+
+struct WorkerStats
+{
+    std::uint64_t tasks;
+    std::chrono::nanoseconds busy_time;
+    std::chrono::nanoseconds idle_time;
+    LatencyHistogram run_times;
+
+    double utilization() const
+    {
+        const auto total = busy_time + idle_time;
+        return total.count() ? static_cast<double>(busy_time.count()) / static_cast<double>(total.count()) : 0.0;
+    }
+};
+
+struct ThreadPoolStats
+{
+    std::vector<WorkerStats> workers;
+    std::array<PriorityQueueStats, priority_levels> queues; // depth & wait times per priority
+
+    static ThreadPoolStats collect(const WorkerCounters* counters, size_t no_of_workers, std::array<PriorityQueueStats, priority_levels> queues)
+    {
+        ThreadPoolStats stats{{}, queues};
+        stats.workers.reserve(no_of_workers);
+        for (size_t i = 0; i < no_of_workers; ++i)
+        {
+            const auto& c = counters[i];
+            stats.workers.push_back({c.tasks.load(std::memory_order_relaxed),
+                std::chrono::nanoseconds{c.busy_ns.load(std::memory_order_relaxed)},
+                std::chrono::nanoseconds{c.idle_ns.load(std::memory_order_relaxed)},
+                c.run_times.snapshot()});
+        }
+        return stats;
+    }
+
+    size_t queue_depth() const
+    {
+        size_t depth = 0;
+        for (const auto& queue : queues)
+            depth += queue.depth;
+        return depth;
+    }
+
+    LatencyHistogram run_times() const
+    {
+        LatencyHistogram total;
+        for (const auto& worker : workers)
+            total += worker.run_times;
+        return total;
+    }
+};
+
+enum class StatsFormat
+{
+    text,
+    json
+};
+
+inline void write_text(std::ostream& out, const ThreadPoolStats& stats)
+{
+    out << "queue depth: " << stats.queue_depth() << "\n";
+    for (size_t level = 0; level < priority_levels; ++level)
+    {
+        const auto& q = stats.queues[level];
+        out << "  " << to_string(static_cast<Priority>(level)) << " - depth: " << q.depth << ", popped: " << q.popped
+            << ", wait p50: " << q.p50_wait.count() << "us, p99: " << q.p99_wait.count() << "us, max: " << q.max_wait.count() << "us\n";
+    }
+
+    for (size_t i = 0; i < stats.workers.size(); ++i)
+    {
+        const auto& w = stats.workers[i];
+        out << "worker #" << i << " - tasks: " << w.tasks << ", utilization: " << static_cast<int>(w.utilization() * 100)
+            << "%, run p50: " << w.run_times.percentile(0.5).count() << "us, p99: " << w.run_times.percentile(0.99).count()
+            << "us, max: " << w.run_times.max().count() << "us\n";
+    }
+}
+
+inline void write_json(std::ostream& out, const ThreadPoolStats& stats)
+{
+    auto us = [](std::chrono::nanoseconds time) { return std::chrono::duration_cast<std::chrono::microseconds>(time).count(); };
+
+    out << "{\"queue_depth\":" << stats.queue_depth() << ",\"queues\":[";
+    for (size_t level = 0; level < priority_levels; ++level)
+    {
+        const auto& q = stats.queues[level];
+        out << (level ? "," : "") << "{\"priority\":\"" << to_string(static_cast<Priority>(level)) << "\",\"depth\":" << q.depth
+            << ",\"popped\":" << q.popped << ",\"wait_mean_us\":" << q.mean_wait.count() << ",\"wait_p50_us\":" << q.p50_wait.count()
+            << ",\"wait_p99_us\":" << q.p99_wait.count() << ",\"wait_max_us\":" << q.max_wait.count() << "}";
+    }
+    out << "],\"workers\":[";
+    for (size_t i = 0; i < stats.workers.size(); ++i)
+    {
+        const auto& w = stats.workers[i];
+        out << (i ? "," : "") << "{\"tasks\":" << w.tasks << ",\"busy_us\":" << us(w.busy_time) << ",\"idle_us\":" << us(w.idle_time)
+            << ",\"run_mean_us\":" << w.run_times.mean().count() << ",\"run_p50_us\":" << w.run_times.percentile(0.5).count()
+            << ",\"run_p99_us\":" << w.run_times.percentile(0.99).count() << ",\"run_max_us\":" << w.run_times.max().count() << "}";
+    }
+    out << "]}\n";
+}
+
+// writes pool.stats() to out every interval until destroyed - must be destroyed before the pool
+template <typename TPool>
+class StatsReporter
+{
+    TPool& pool_;
+    std::ostream& out_;
+    const std::chrono::steady_clock::duration interval_;
+    const StatsFormat format_;
+    std::mutex mtx_;
+    std::condition_variable_any cv_;
+    std::jthread thd_; // started last
+
+public:
+    StatsReporter(TPool& pool, std::ostream& out, std::chrono::steady_clock::duration interval, StatsFormat format = StatsFormat::text)
+        : pool_{pool}
+        , out_{out}
+        , interval_{interval}
+        , format_{format}
+        , thd_{[this](std::stop_token stop_token) { run(stop_token); }}
+    {
+    }
+
+    StatsReporter(const StatsReporter&) = delete;
+    StatsReporter& operator=(const StatsReporter&) = delete;
+
+private:
+    void run(std::stop_token stop_token)
+    {
+        std::unique_lock lk{mtx_};
+        while (!cv_.wait_for(lk, stop_token, interval_, [] { return false; }) && !stop_token.stop_requested())
+        {
+            if (format_ == StatsFormat::json)
+                write_json(out_, pool_.stats());
+            else
+                write_text(out_, pool_.stats());
+            out_.flush();
+        }
+    }
+};
+
+#endif // POOL_METRICS_HPP
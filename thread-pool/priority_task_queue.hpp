@@ -0,0 +1,300 @@
+#ifndef PRIORITY_TASK_QUEUE_HPP
+#define PRIORITY_TASK_QUEUE_HPP
+
+#include "latency_histogram.hpp"
+#include "thread_safe_queue.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <mutex>
+#include <ranges>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+enum class Priority
+{
+    high,
+    normal,
+    low
+};
+
+inline constexpr size_t priority_levels = 3;
+
+inline const char* to_string(Priority priority)
+{
+    constexpr const char* names[priority_levels] = {"high", "normal", "low"};
+    return names[static_cast<size_t>(priority)];
+}
+
+struct PriorityQueueStats
+{
+    size_t depth;
+    std::uint64_t popped;
+    std::chrono::microseconds mean_wait;
+    std::chrono::microseconds p50_wait;
+    std::chrono::microseconds p99_wait;
+    std::chrono::microseconds max_wait;
+};
+
+// one FIFO queue per priority level behind a single lock
+// - pop takes the front with the best effective priority: level - waited / aging_step (ties go to the higher priority),
+//   so a waiting task gains one level per aging_step - it can be overtaken only by tasks pushed
+//   less than level * aging_step after it and never starves
+// - tasks pushed earlier with the same or a higher priority are always popped first
+template <typename T>
+class PriorityTaskQueue
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr size_t unbounded = std::numeric_limits<size_t>::max();
+
+private:
+    struct Entry
+    {
+        T item;
+        Clock::time_point enqueued;
+    };
+
+    std::array<RecyclingBlockStorage<Entry>, priority_levels> queues_;
+    std::array<LatencyHistogram, priority_levels> wait_times_;
+    const size_t capacity_;
+    const Clock::duration aging_step_;
+    size_t size_ = 0;
+    std::atomic<size_t> unfinished_{0}; // pushed, but not yet marked with task_done()
+    bool is_closed_ = false;
+    mutable std::mutex mtx_q_;
+    std::condition_variable cv_q_not_empty_;
+    std::condition_variable cv_q_not_full_;
+
+public:
+    // capacity counts tasks of all priorities - push blocks when it is reached (force_push may exceed it)
+    explicit PriorityTaskQueue(size_t capacity = unbounded, Clock::duration aging_step = std::chrono::milliseconds{100})
+        : capacity_{capacity}
+        , aging_step_{aging_step}
+    {
+        if (aging_step_ <= Clock::duration::zero())
+            throw std::invalid_argument("Aging step must be positive");
+    }
+
+    PriorityTaskQueue(const PriorityTaskQueue&) = delete;
+    PriorityTaskQueue& operator=(const PriorityTaskQueue&) = delete;
+
+    size_t size() const
+    {
+        std::lock_guard lk{mtx_q_};
+        return size_;
+    }
+
+    bool empty() const
+    {
+        return size() == 0;
+    }
+
+    // pops on a closed & empty queue return false, pushes throw
+    void close()
+    {
+        {
+            std::lock_guard lk{mtx_q_};
+            is_closed_ = true;
+        }
+        cv_q_not_empty_.notify_all();
+        cv_q_not_full_.notify_all();
+    }
+
+    void push(T item, Priority priority = Priority::normal)
+    {
+        {
+            std::unique_lock lk{mtx_q_};
+            wait_for_room(lk, 1);
+            queues_[static_cast<size_t>(priority)].emplace(std::move(item), Clock::now());
+            ++size_;
+            unfinished_.fetch_add(1, std::memory_order_relaxed);
+        }
+        cv_q_not_empty_.notify_one();
+    }
+
+    // ignores capacity - for tasks pushed by the consumers themselves (e.g. continuations scheduled by workers):
+    // a worker blocked on a full queue that only workers drain could deadlock the pool
+    void force_push(T item, Priority priority = Priority::normal)
+    {
+        {
+            std::lock_guard lk{mtx_q_};
+            if (is_closed_)
+                throw std::runtime_error("Push to closed queue");
+            queues_[static_cast<size_t>(priority)].emplace(std::move(item), Clock::now());
+            ++size_;
+            unfinished_.fetch_add(1, std::memory_order_relaxed);
+        }
+        cv_q_not_empty_.notify_one();
+    }
+
+    // items are pushed as the range yields them - moved only from a range of rvalues (std::views::as_rvalue, move iterators)
+    // - one lock & one enqueue time for the whole range; a bounded queue restamps items pushed after waiting for room
+    // - when the queue is closed while waiting, the items pushed so far stay queued
+    template <std::ranges::input_range TRange>
+    void push_range(TRange&& items, Priority priority = Priority::normal)
+    {
+        auto& queue = queues_[static_cast<size_t>(priority)];
+
+        size_t count = 0;
+        try
+        {
+            std::unique_lock lk{mtx_q_};
+            auto now = Clock::now();
+            for (auto&& item : items)
+            {
+                if (wait_for_room(lk, 1))
+                    now = Clock::now();
+                queue.emplace(std::forward<decltype(item)>(item), now);
+                ++size_;
+                ++count;
+                unfinished_.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+        catch (...)
+        {
+            notify_pushed(count);
+            throw;
+        }
+
+        notify_pushed(count);
+    }
+
+    bool try_pop(T& item)
+    {
+        std::unique_lock lk{mtx_q_};
+        return pop_best(lk, item);
+    }
+
+    // blocks until an item is available - returns false when the queue is closed & drained
+    bool pop(T& item)
+    {
+        std::unique_lock lk{mtx_q_};
+        cv_q_not_empty_.wait(lk, [this] { return size_ > 0 || is_closed_; });
+        return pop_best(lk, item);
+    }
+
+    // removes all queued items - higher priorities first, FIFO within a priority
+    std::vector<T> take_all()
+    {
+        std::vector<T> items;
+        {
+            std::lock_guard lk{mtx_q_};
+            items.reserve(size_);
+            for (auto& queue : queues_)
+            {
+                for (; !queue.empty(); queue.pop())
+                    items.push_back(std::move(queue.front().item));
+            }
+            size_ = 0;
+        }
+
+        if (capacity_ != unbounded)
+            cv_q_not_full_.notify_all();
+        done(items.size());
+        return items;
+    }
+
+    // consumer finished processing a popped item
+    void task_done()
+    {
+        done(1);
+    }
+
+    // blocks until every pushed item was popped & marked with task_done() (or removed with take_all)
+    void wait_done() const
+    {
+        size_t unfinished;
+        while ((unfinished = unfinished_.load(std::memory_order_acquire)) != 0)
+            unfinished_.wait(unfinished, std::memory_order_acquire);
+    }
+
+    std::array<PriorityQueueStats, priority_levels> stats() const
+    {
+        std::lock_guard lk{mtx_q_};
+
+        std::array<PriorityQueueStats, priority_levels> result;
+        for (size_t level = 0; level < priority_levels; ++level)
+        {
+            const auto& wait_times = wait_times_[level];
+            result[level] = {queues_[level].size(), wait_times.count(), wait_times.mean(),
+                wait_times.percentile(0.5), wait_times.percentile(0.99), wait_times.max()};
+        }
+        return result;
+    }
+
+private:
+    void done(size_t count)
+    {
+        if (count > 0 && unfinished_.fetch_sub(count, std::memory_order_acq_rel) == count)
+            unfinished_.notify_all();
+    }
+
+    void notify_pushed(size_t count)
+    {
+        if (count == 1)
+            cv_q_not_empty_.notify_one();
+        else if (count > 1)
+            cv_q_not_empty_.notify_all();
+    }
+
+    // returns true when it had to wait
+    bool wait_for_room(std::unique_lock<std::mutex>& lk, size_t count)
+    {
+        if (is_closed_)
+            throw std::runtime_error("Push to closed queue");
+
+        if (capacity_ == unbounded || size_ + count <= capacity_)
+            return false;
+
+        cv_q_not_empty_.notify_all(); // consumers may still sleep if the queue was filled under this lock
+        cv_q_not_full_.wait(lk, [this, count] { return size_ + count <= capacity_ || is_closed_; });
+        if (is_closed_)
+            throw std::runtime_error("Push to closed queue");
+        return true;
+    }
+
+    bool pop_best(std::unique_lock<std::mutex>& lk, T& item)
+    {
+        if (size_ == 0)
+            return false;
+
+        const auto now = Clock::now();
+
+        size_t best_level = priority_levels;
+        std::int64_t best_rank = 0;
+        for (size_t level = 0; level < priority_levels; ++level)
+        {
+            if (queues_[level].empty())
+                continue;
+
+            const std::int64_t rank = static_cast<std::int64_t>(level) - (now - queues_[level].front().enqueued) / aging_step_;
+            if (best_level == priority_levels || rank < best_rank)
+            {
+                best_level = level;
+                best_rank = rank;
+            }
+        }
+
+        auto& queue = queues_[best_level];
+        wait_times_[best_level].add(std::chrono::duration_cast<std::chrono::microseconds>(now - queue.front().enqueued));
+        item = std::move(queue.front().item);
+        queue.pop();
+        --size_;
+        lk.unlock();
+
+        if (capacity_ != unbounded)
+            cv_q_not_full_.notify_one();
+        return true;
+    }
+};
+
+#endif // PRIORITY_TASK_QUEUE_HPP
@@ -0,0 +1,205 @@
+#ifndef RECYCLING_ALLOCATOR_HPP
+#define RECYCLING_ALLOCATOR_HPP
+
+#include <array>
+#include <cstddef>
+#include <mutex>
+#include <new>
+#include <vector>
+
+namespace Details
+{
+    // Small blocks grouped in size classes of 64 bytes. Every thread caches freed blocks in its own
+    // free lists; surplus blocks travel in batches through a shared depot, so blocks freed by worker
+    // threads find their way back to submitting threads with one lock per batch_size blocks.
+    struct BlockSizeClasses
+    {
+        static constexpr size_t step = 64;
+        static constexpr size_t count = 8;
+        static constexpr size_t max_block_size = step * count;
+        static constexpr size_t batch_size = 64;
+
+        static size_t index(size_t size)
+        {
+            return (size - 1) / step;
+        }
+
+        static size_t block_size(size_t index)
+        {
+            return (index + 1) * step;
+        }
+    };
+
+    struct FreeBlock
+    {
+        FreeBlock* next;
+    };
+
+    class BlockDepot
+    {
+        static constexpr size_t max_batches = 1024;
+
+        std::mutex mtx_;
+        std::array<std::vector<FreeBlock*>, BlockSizeClasses::count> batches_; // chains of batch_size blocks
+
+    public:
+        static BlockDepot& instance()
+        {
+            static BlockDepot depot;
+            return depot;
+        }
+
+        ~BlockDepot()
+        {
+            for (auto& batches : batches_)
+                for (FreeBlock* batch : batches)
+                    release_chain(batch);
+        }
+
+        static void release_chain(FreeBlock* block)
+        {
+            while (block)
+            {
+                FreeBlock* next = block->next;
+                ::operator delete(block);
+                block = next;
+            }
+        }
+
+        FreeBlock* take_batch(size_t index)
+        {
+            std::lock_guard lk{mtx_};
+            if (batches_[index].empty())
+                return nullptr;
+            FreeBlock* batch = batches_[index].back();
+            batches_[index].pop_back();
+            return batch;
+        }
+
+        void put_batch(size_t index, FreeBlock* batch)
+        {
+            {
+                std::lock_guard lk{mtx_};
+                if (batches_[index].size() < max_batches)
+                {
+                    batches_[index].push_back(batch);
+                    return;
+                }
+            }
+            release_chain(batch);
+        }
+    };
+
+    class BlockCache
+    {
+        BlockDepot& depot_ = BlockDepot::instance(); // constructed first - destroyed after all caches
+        std::array<FreeBlock*, BlockSizeClasses::count> free_lists_{};
+        std::array<size_t, BlockSizeClasses::count> counts_{};
+
+    public:
+        BlockCache() = default;
+
+        BlockCache(const BlockCache&) = delete;
+        BlockCache& operator=(const BlockCache&) = delete;
+
+        ~BlockCache()
+        {
+            for (auto& free_list : free_lists_)
+                BlockDepot::release_chain(free_list);
+        }
+
+        static BlockCache& this_thread()
+        {
+            thread_local BlockCache cache;
+            return cache;
+        }
+
+        void* allocate(size_t size)
+        {
+            if (size == 0 || size > BlockSizeClasses::max_block_size)
+                return ::operator new(size);
+
+            const auto index = BlockSizeClasses::index(size);
+
+            if (free_lists_[index] == nullptr)
+            {
+                free_lists_[index] = depot_.take_batch(index);
+                counts_[index] = free_lists_[index] ? BlockSizeClasses::batch_size : 0;
+            }
+
+            if (FreeBlock* block = free_lists_[index])
+            {
+                free_lists_[index] = block->next;
+                --counts_[index];
+                return block;
+            }
+
+            return ::operator new(BlockSizeClasses::block_size(index));
+        }
+
+        void deallocate(void* ptr, size_t size) noexcept
+        {
+            if (size == 0 || size > BlockSizeClasses::max_block_size)
+            {
+                ::operator delete(ptr);
+                return;
+            }
+
+            const auto index = BlockSizeClasses::index(size);
+            free_lists_[index] = ::new (ptr) FreeBlock{free_lists_[index]};
+
+            if (++counts_[index] == 2 * BlockSizeClasses::batch_size) // hand surplus over to other threads
+            {
+                FreeBlock* batch = free_lists_[index];
+                FreeBlock* last = batch;
+                for (size_t i = 1; i < BlockSizeClasses::batch_size; ++i)
+                    last = last->next;
+
+                free_lists_[index] = last->next;
+                last->next = nullptr;
+                counts_[index] -= BlockSizeClasses::batch_size;
+
+                depot_.put_batch(index, batch);
+            }
+        }
+    };
+}
+
+// allocator for small, short-lived objects (e.g. shared states of promises)
+// - blocks are recycled through thread-local caches instead of the general allocator
+template <typename T>
+struct RecyclingAllocator
+{
+    using value_type = T;
+
+    RecyclingAllocator() = default;
+
+    template <typename U>
+    RecyclingAllocator(const RecyclingAllocator<U>&) noexcept
+    {
+    }
+
+    T* allocate(size_t n)
+    {
+        if constexpr (alignof(T) > __STDCPP_DEFAULT_NEW_ALIGNMENT__)
+            return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t{alignof(T)}));
+        else
+            return static_cast<T*>(Details::BlockCache::this_thread().allocate(n * sizeof(T)));
+    }
+
+    void deallocate(T* ptr, size_t n) noexcept
+    {
+        if constexpr (alignof(T) > __STDCPP_DEFAULT_NEW_ALIGNMENT__)
+            ::operator delete(ptr, std::align_val_t{alignof(T)});
+        else
+            Details::BlockCache::this_thread().deallocate(ptr, n * sizeof(T));
+    }
+
+    template <typename U>
+    bool operator==(const RecyclingAllocator<U>&) const noexcept
+    {
+        return true;
+    }
+};
+
+#endif // RECYCLING_ALLOCATOR_HPP
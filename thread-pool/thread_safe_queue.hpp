@@ -1,74 +1,602 @@
 #ifndef THREAD_SAFE_QUEUE_HPP
 #define THREAD_SAFE_QUEUE_HPP
 
+#include <chrono>
+#include <concepts>
 #include <condition_variable>
+#include <cstddef>
+#include <limits>
+#include <memory>
 #include <mutex>
 #include <queue>
+#include <ranges>
+#include <stdexcept>
+#include <stop_token>
+#include <type_traits>
+#include <utility>
 
+// what push does when a bounded queue is full
+enum class OverflowPolicy
+{
+    block,       // wait until a consumer makes room
+    drop_oldest, // evict the front item
+    drop_newest  // discard the pushed item
+};
+
+// Storage policies for ThreadSafeQueue - same interface as std::queue:
+// empty(), size(), front(), push(), emplace(), pop()
+
+// fixed-capacity ring buffer - allocated once in the constructor
 template <typename T>
+class RingBufferStorage
+{
+    std::allocator<T> allocator_;
+    const size_t capacity_;
+    T* const buffer_;
+    size_t head_ = 0;
+    size_t size_ = 0;
+
+public:
+    explicit RingBufferStorage(size_t capacity)
+        : capacity_{capacity}
+        , buffer_{allocator_.allocate(capacity)}
+    {
+    }
+
+    RingBufferStorage(const RingBufferStorage&) = delete;
+    RingBufferStorage& operator=(const RingBufferStorage&) = delete;
+
+    ~RingBufferStorage()
+    {
+        while (!empty())
+            pop();
+        allocator_.deallocate(buffer_, capacity_);
+    }
+
+    size_t capacity() const
+    {
+        return capacity_;
+    }
+
+    bool empty() const
+    {
+        return size_ == 0;
+    }
+
+    size_t size() const
+    {
+        return size_;
+    }
+
+    T& front()
+    {
+        return buffer_[head_];
+    }
+
+    void push(const T& item)
+    {
+        emplace(item);
+    }
+
+    void push(T&& item)
+    {
+        emplace(std::move(item));
+    }
+
+    template <typename... TArgs>
+    void emplace(TArgs&&... args)
+    {
+        std::construct_at(buffer_ + (head_ + size_) % capacity_, std::forward<TArgs>(args)...);
+        ++size_;
+    }
+
+    void pop()
+    {
+        std::destroy_at(buffer_ + head_);
+        head_ = (head_ + 1) % capacity_;
+        --size_;
+    }
+};
+
+// unbounded list of fixed-size blocks - drained blocks go to a free list instead of the allocator,
+// so once the queue reaches its high-water mark push/pop never allocate
+template <typename T, size_t BlockSize = 64>
+class RecyclingBlockStorage
+{
+    struct Block
+    {
+        Block* next = nullptr;
+        alignas(T) std::byte slots[BlockSize * sizeof(T)];
+
+        T* slot(size_t index)
+        {
+            return reinterpret_cast<T*>(slots) + index;
+        }
+    };
+
+    Block* head_block_ = nullptr;
+    Block* tail_block_ = nullptr;
+    Block* free_blocks_ = nullptr;
+    size_t head_index_ = 0;
+    size_t tail_index_ = 0;
+    size_t size_ = 0;
+
+    Block* acquire_block()
+    {
+        if (free_blocks_ == nullptr)
+            return new Block;
+
+        Block* block = free_blocks_;
+        free_blocks_ = block->next;
+        block->next = nullptr;
+        return block;
+    }
+
+    void release_block(Block* block)
+    {
+        block->next = free_blocks_;
+        free_blocks_ = block;
+    }
+
+    static void delete_blocks(Block* block)
+    {
+        while (block)
+            delete std::exchange(block, block->next);
+    }
+
+public:
+    RecyclingBlockStorage() = default;
+
+    RecyclingBlockStorage(const RecyclingBlockStorage&) = delete;
+    RecyclingBlockStorage& operator=(const RecyclingBlockStorage&) = delete;
+
+    ~RecyclingBlockStorage()
+    {
+        while (!empty())
+            pop();
+        delete_blocks(head_block_);
+        delete_blocks(free_blocks_);
+    }
+
+    bool empty() const
+    {
+        return size_ == 0;
+    }
+
+    size_t size() const
+    {
+        return size_;
+    }
+
+    T& front()
+    {
+        return *head_block_->slot(head_index_);
+    }
+
+    void push(const T& item)
+    {
+        emplace(item);
+    }
+
+    void push(T&& item)
+    {
+        emplace(std::move(item));
+    }
+
+    template <typename... TArgs>
+    void emplace(TArgs&&... args)
+    {
+        if (tail_block_ == nullptr)
+            head_block_ = tail_block_ = acquire_block();
+
+        if (tail_index_ < BlockSize)
+        {
+            std::construct_at(tail_block_->slot(tail_index_), std::forward<TArgs>(args)...);
+            ++tail_index_;
+        }
+        else // tail block is full - link the next one
+        {
+            Block* block = acquire_block();
+            try
+            {
+                std::construct_at(block->slot(0), std::forward<TArgs>(args)...);
+            }
+            catch (...)
+            {
+                release_block(block);
+                throw;
+            }
+            tail_block_ = tail_block_->next = block;
+            tail_index_ = 1;
+        }
+        ++size_;
+    }
+
+    void pop()
+    {
+        std::destroy_at(head_block_->slot(head_index_));
+        ++head_index_;
+        --size_;
+
+        if (size_ == 0) // reuse the current block from the start
+        {
+            head_index_ = tail_index_ = 0;
+        }
+        else if (head_index_ == BlockSize)
+        {
+            release_block(std::exchange(head_block_, head_block_->next));
+            head_index_ = 0;
+        }
+    }
+};
+
+template <typename TStorage>
+concept FixedCapacityStorage = requires(const TStorage& storage) {
+    { storage.capacity() } -> std::convertible_to<size_t>;
+};
+
+template <typename T, typename TStorage = std::queue<T>>
 class ThreadSafeQueue
 {
-    std::queue<T> q_;
+public:
+    static constexpr size_t unbounded = std::numeric_limits<size_t>::max();
+
+private:
+    TStorage q_;
+    const size_t capacity_ = unbounded;
+    const OverflowPolicy overflow_policy_ = OverflowPolicy::block;
+    bool is_closed_ = false;
     mutable std::mutex mtx_q_;
-    std::condition_variable cv_q_not_empty_;
+    std::condition_variable_any cv_q_not_empty_; // _any - supports waiting with std::stop_token
+    std::condition_variable cv_q_not_full_;
 
 public:
-    ThreadSafeQueue() = default;
+    ThreadSafeQueue() requires(!FixedCapacityStorage<TStorage>) = default;
+
+    // fixed-capacity storages are sized with capacity
+    explicit ThreadSafeQueue(size_t capacity, OverflowPolicy overflow_policy = OverflowPolicy::block)
+        : q_{make_storage(capacity)}
+        , capacity_{capacity}
+        , overflow_policy_{overflow_policy}
+    {
+    }
 
     ThreadSafeQueue(const ThreadSafeQueue&) = delete;
     ThreadSafeQueue& operator=(const ThreadSafeQueue&) = delete;
 
+    size_t capacity() const
+    {
+        return capacity_;
+    }
+
     bool empty() const
     {
         std::lock_guard lk{mtx_q_};
         return q_.empty();
     }
 
-    void push(const T& item)
+    size_t size() const
+    {
+        std::lock_guard lk{mtx_q_};
+        return q_.size();
+    }
+
+    // wakes all waiting consumers and producers - remaining items can still be popped,
+    // pops on a closed & empty queue return false, pushes throw (try_push/push_for return false)
+    void close()
     {
         {
             std::lock_guard lk{mtx_q_};
-            q_.push(item);
+            is_closed_ = true;
         }
-        cv_q_not_empty_.notify_one();
+        cv_q_not_empty_.notify_all();
+        cv_q_not_full_.notify_all();
+    }
+
+    bool is_closed() const
+    {
+        std::lock_guard lk{mtx_q_};
+        return is_closed_;
+    }
+
+    void push(const T& item)
+    {
+        emplace(item);
     }
 
     void push(T&& item)
+    {
+        emplace(std::move(item));
+    }
+
+    template <typename... TArgs>
+    void emplace(TArgs&&... args)
+    {
+        {
+            std::unique_lock lk{mtx_q_};
+            if (!make_room(lk))
+                return;
+            q_.emplace(std::forward<TArgs>(args)...);
+        }
+        cv_q_not_empty_.notify_one();
+    }
+
+    // never blocks - returns false when the item was not enqueued
+    bool try_push(T item)
     {
         {
             std::lock_guard lk{mtx_q_};
+            if (is_closed_)
+                return false;
+            if (is_full() && overflow_policy_ != OverflowPolicy::drop_oldest)
+                return false;
+            if (is_full())
+                q_.pop();
+            q_.push(std::move(item));
+        }
+        cv_q_not_empty_.notify_one();
+        return true;
+    }
+
+    // waits at most timeout for a free slot - returns false when the item was not enqueued
+    template <typename TRep, typename TPeriod>
+    bool push_for(T item, std::chrono::duration<TRep, TPeriod> timeout)
+    {
+        {
+            std::unique_lock lk{mtx_q_};
+            if (overflow_policy_ == OverflowPolicy::block)
+            {
+                if (!cv_q_not_full_.wait_for(lk, timeout, [this] { return !is_full() || is_closed_; }) || is_closed_)
+                    return false;
+            }
+            else if (is_closed_)
+                return false;
+            else if (!make_room(lk))
+                return false;
             q_.push(std::move(item));
         }
         cv_q_not_empty_.notify_one();
+        return true;
     }
 
+    // when a push throws (closed queue, copy of an item), the items pushed so far stay queued
     void push(std::initializer_list<T> lst)
     {
+        size_t count = 0;
+        try
         {
-            std::lock_guard lk{mtx_q_};
+            std::unique_lock lk{mtx_q_};
             for (const auto& item : lst)
+            {
+                if (!make_room(lk))
+                    continue;
+
                 q_.push(item);
+                ++count;
+            }
         }
-        cv_q_not_empty_.notify_all();
+        catch (...)
+        {
+            notify_pushed(count);
+            throw;
+        }
+
+        notify_pushed(count);
+    }
+
+    // items of an owning range passed as an rvalue (push_range(std::move(vec))) are moved,
+    // otherwise they are pushed as the range yields them - copied from an lvalue container or a view over it,
+    // moved from a std::move_iterator range
+    // - when a push throws (closed queue, copy of an item), the items pushed so far stay queued
+    template <std::ranges::input_range TRange>
+    void push_range(TRange&& items)
+    {
+        constexpr bool is_owning_rvalue = !std::ranges::borrowed_range<TRange> && !std::ranges::view<std::remove_cvref_t<TRange>>;
+
+        size_t count = 0;
+        try
+        {
+            std::unique_lock lk{mtx_q_};
+            for (auto&& item : items)
+            {
+                if (!make_room(lk))
+                    continue;
+
+                if constexpr (is_owning_rvalue)
+                    q_.push(std::move(item));
+                else
+                    q_.push(std::forward<decltype(item)>(item));
+                ++count;
+            }
+        }
+        catch (...)
+        {
+            notify_pushed(count);
+            throw;
+        }
+
+        notify_pushed(count);
     }
 
     bool try_pop(T& item)
     {
-        std::unique_lock lk{mtx_q_, std::try_to_lock};
-        if (!lk.owns_lock() || q_.empty())
-            return false;
-        item = std::move(q_.front());
-        q_.pop();
+        {
+            std::unique_lock lk{mtx_q_, std::try_to_lock};
+            if (!lk.owns_lock() || q_.empty())
+                return false;
+            item = std::move(q_.front());
+            q_.pop();
+        }
+        notify_not_full(1);
         return true;
     }
 
-    void pop(T& item)
+    // returns false only when the queue is closed and empty
+    bool pop(T& item)
+    {
+        std::unique_lock lk{mtx_q_};
+        cv_q_not_empty_.wait(lk, [this] { return !q_.empty() || is_closed_; });
+
+        return pop_front(lk, item);
+    }
+
+    // returns false when stop is requested before an item arrives or the queue is closed and empty
+    bool pop(T& item, std::stop_token stop_token)
+    {
+        std::unique_lock lk{mtx_q_};
+        cv_q_not_empty_.wait(lk, stop_token, [this] { return !q_.empty() || is_closed_; });
+
+        return pop_front(lk, item);
+    }
+
+    template <typename TRep, typename TPeriod>
+    bool pop_for(T& item, std::chrono::duration<TRep, TPeriod> timeout)
     {
         std::unique_lock lk{mtx_q_};
-        cv_q_not_empty_.wait(lk, [this] { return !q_.empty(); });
+        cv_q_not_empty_.wait_for(lk, timeout, [this] { return !q_.empty() || is_closed_; });
+
+        return pop_front(lk, item);
+    }
+
+    // returns false after timeout, when stop is requested before an item arrives or the queue is closed and empty
+    template <typename TRep, typename TPeriod>
+    bool pop_for(T& item, std::chrono::duration<TRep, TPeriod> timeout, std::stop_token stop_token)
+    {
+        std::unique_lock lk{mtx_q_};
+        cv_q_not_empty_.wait_for(lk, stop_token, timeout, [this] { return !q_.empty() || is_closed_; });
+
+        return pop_front(lk, item);
+    }
+
+    template <typename TClock, typename TDuration>
+    bool pop_until(T& item, std::chrono::time_point<TClock, TDuration> deadline)
+    {
+        std::unique_lock lk{mtx_q_};
+        cv_q_not_empty_.wait_until(lk, deadline, [this] { return !q_.empty() || is_closed_; });
+
+        return pop_front(lk, item);
+    }
+
+    // drains up to max_n items under a single lock - returns number of popped items
+    template <typename TOutputIterator>
+    size_t try_pop_bulk(TOutputIterator out, size_t max_n)
+    {
+        size_t count = 0;
+        {
+            std::unique_lock lk{mtx_q_, std::try_to_lock};
+            if (!lk.owns_lock())
+                return 0;
+            count = pop_available(out, max_n);
+        }
+        notify_not_full(count);
+        return count;
+    }
+
+    // waits for at least one item, then drains up to max_n items under a single lock
+    // - returns 0 only when the queue is closed and empty or max_n == 0 (without waiting)
+    template <typename TOutputIterator>
+    size_t pop_bulk(TOutputIterator out, size_t max_n)
+    {
+        if (max_n == 0)
+            return 0;
+
+        size_t count = 0;
+        {
+            std::unique_lock lk{mtx_q_};
+            cv_q_not_empty_.wait(lk, [this] { return !q_.empty() || is_closed_; });
+            count = pop_available(out, max_n);
+        }
+        notify_not_full(count);
+        return count;
+    }
+
+private:
+    static TStorage make_storage(size_t capacity)
+    {
+        if constexpr (FixedCapacityStorage<TStorage>)
+        {
+            if (capacity == unbounded)
+                throw std::invalid_argument("Fixed-capacity storage requires a bounded queue");
+            return TStorage(capacity);
+        }
+        else
+            return TStorage{};
+    }
+
+    bool is_full() const
+    {
+        return q_.size() >= capacity_;
+    }
+
+    // applies the overflow policy - returns false when the new item must be dropped
+    bool make_room(std::unique_lock<std::mutex>& lk)
+    {
+        if (is_closed_)
+            throw std::runtime_error("Push to closed queue");
+
+        if (!is_full())
+            return true;
+
+        switch (overflow_policy_)
+        {
+        case OverflowPolicy::drop_newest:
+            return false;
+        case OverflowPolicy::drop_oldest:
+            q_.pop();
+            return true;
+        case OverflowPolicy::block:
+            cv_q_not_empty_.notify_all(); // consumers may still sleep if the queue was filled under this lock
+            cv_q_not_full_.wait(lk, [this] { return !is_full() || is_closed_; });
+            if (is_closed_)
+                throw std::runtime_error("Push to closed queue");
+            return true;
+        }
+
+        return true;
+    }
+
+    bool pop_front(std::unique_lock<std::mutex>& lk, T& item)
+    {
+        if (q_.empty())
+            return false;
 
         item = std::move(q_.front());
         q_.pop();
+        lk.unlock();
+
+        notify_not_full(1);
+        return true;
+    }
+
+    void notify_pushed(size_t count)
+    {
+        if (count == 1)
+            cv_q_not_empty_.notify_one();
+        else if (count > 1)
+            cv_q_not_empty_.notify_all();
+    }
+
+    void notify_not_full(size_t count)
+    {
+        if (capacity_ == unbounded || count == 0)
+            return;
+
+        if (count == 1)
+            cv_q_not_full_.notify_one();
+        else
+            cv_q_not_full_.notify_all();
+    }
+
+    template <typename TOutputIterator>
+    size_t pop_available(TOutputIterator out, size_t max_n)
+    {
+        size_t count = 0;
+        for (; count < max_n && !q_.empty(); ++count)
+        {
+            *out++ = std::move(q_.front());
+            q_.pop();
+        }
+        return count;
     }
 };
 
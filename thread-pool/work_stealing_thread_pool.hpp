@@ -0,0 +1,276 @@
+#ifndef WORK_STEALING_THREAD_POOL_HPP
+#define WORK_STEALING_THREAD_POOL_HPP
+
+#include "cache_line.hpp"
+#include "cpu_topology.hpp"
+#include "inline_task.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace WorkStealing
+{
+    using Task = InlineTask;
+
+    // per-worker deque: the owner works on the back (LIFO), thieves take from the front (FIFO)
+    class WorkStealingQueue
+    {
+        std::deque<Task> q_;
+        std::mutex mtx_q_;
+
+    public:
+        WorkStealingQueue() = default;
+
+        WorkStealingQueue(const WorkStealingQueue&) = delete;
+        WorkStealingQueue& operator=(const WorkStealingQueue&) = delete;
+
+        void push(Task task)
+        {
+            std::lock_guard lk{mtx_q_};
+            q_.push_back(std::move(task));
+        }
+
+        bool try_pop(Task& task) // owner
+        {
+            std::lock_guard lk{mtx_q_};
+            if (q_.empty())
+                return false;
+            task = std::move(q_.back());
+            q_.pop_back();
+            return true;
+        }
+
+        bool try_steal(Task& task) // thief - gives up when the owner holds the lock
+        {
+            std::unique_lock lk{mtx_q_, std::try_to_lock};
+            if (!lk.owns_lock() || q_.empty())
+                return false;
+            task = std::move(q_.front());
+            q_.pop_front();
+            return true;
+        }
+
+        bool steal(Task& task) // thief - waits for the lock
+        {
+            std::lock_guard lk{mtx_q_};
+            if (q_.empty())
+                return false;
+            task = std::move(q_.front());
+            q_.pop_front();
+            return true;
+        }
+    };
+
+    // pinned - worker i runs on the i-th cpu in node order; external submissions go to workers
+    // on the node of the submitting cpu and thieves steal from their own node first
+    class ThreadPool
+    {
+    public:
+        ThreadPool(size_t size, ThreadPlacement placement = ThreadPlacement::unpinned)
+            : size_{size}
+            , workers_{std::make_unique<Worker[]>(size)}
+        {
+            const CpuTopology topology;
+            const std::vector<int> cpus = topology.cpus_by_node();
+
+            if (placement == ThreadPlacement::pinned)
+            {
+                node_workers_.resize(topology.nodes().size());
+                for (int cpu : cpus)
+                {
+                    if (cpu_nodes_.size() <= static_cast<size_t>(cpu))
+                        cpu_nodes_.resize(cpu + 1, 0);
+                    cpu_nodes_[cpu] = topology.node_index_of(cpu);
+                }
+            }
+            else
+                node_workers_.resize(1); // floating workers - one group
+
+            for (size_t i = 0; i < size; ++i)
+            {
+                workers_[i].node = placement == ThreadPlacement::pinned ? topology.node_index_of(cpus[i % cpus.size()]) : 0;
+                node_workers_[workers_[i].node].push_back(i);
+            }
+
+            for (size_t i = 0; i < size; ++i)
+                workers_[i].victims = steal_order(i);
+
+            threads_.reserve(size);
+            for (size_t i = 0; i < size; ++i)
+            {
+                const int cpu = placement == ThreadPlacement::pinned ? cpus[i % cpus.size()] : -1;
+                threads_.push_back(std::jthread{[this, i, cpu] {
+                    if (cpu >= 0)
+                        pin_this_thread_to_cpu(cpu); // before the first task
+                    run(i);
+                }});
+            }
+        }
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        ThreadPool(ThreadPool&&) = delete;
+        ThreadPool& operator=(ThreadPool&&) = delete;
+
+        ~ThreadPool()
+        {
+            {
+                std::lock_guard lk{mtx_idle_};
+                is_done_ = true;
+            }
+            cv_idle_.notify_all();
+
+            threads_.clear(); // workers drain all deques before joining
+        }
+
+        template <typename TTask>
+        auto submit(TTask&& task)
+        {
+            auto [pt, f_result] = make_task_with_future(std::forward<TTask>(task));
+            push(std::move(pt));
+
+            return std::move(f_result);
+        }
+
+    private:
+        struct alignas(Hardware::cache_line_size) Worker
+        {
+            WorkStealingQueue tasks;
+            size_t node = 0;
+            std::vector<size_t> victims; // other workers - same node first
+        };
+
+        const size_t size_;
+        std::unique_ptr<Worker[]> workers_;
+        std::vector<std::vector<size_t>> node_workers_; // worker indexes per node
+        std::vector<size_t> cpu_nodes_;                 // node of every cpu - empty when unpinned
+
+        alignas(Hardware::cache_line_size) std::atomic<size_t> pending_tasks_{0};
+        alignas(Hardware::cache_line_size) std::atomic<size_t> idle_workers_{0};
+
+        std::mutex mtx_idle_;
+        std::condition_variable cv_idle_;
+        bool is_done_ = false;
+
+        std::vector<std::jthread> threads_;
+
+        inline static thread_local const ThreadPool* this_pool_ = nullptr;
+        inline static thread_local size_t this_worker_index_ = 0;
+
+        void push(Task task)
+        {
+            pending_tasks_.fetch_add(1);
+
+            if (this_pool_ == this)
+            {
+                workers_[this_worker_index_].tasks.push(std::move(task)); // local submission
+            }
+            else
+            {
+                // external submission - spread over workers of the submitting node without touching a shared counter
+                static thread_local size_t next_index = std::hash<std::thread::id>{}(std::this_thread::get_id());
+                const auto& local_workers = node_workers_[submitting_node()];
+                if (local_workers.empty())
+                    workers_[next_index++ % size_].tasks.push(std::move(task));
+                else
+                    workers_[local_workers[next_index++ % local_workers.size()]].tasks.push(std::move(task));
+            }
+
+            if (idle_workers_.load() > 0) // seq_cst - a worker going idle sees pending_tasks_ > 0 otherwise
+            {
+                {
+                    std::lock_guard lk{mtx_idle_}; // pairs with the predicate check in run()
+                }
+                cv_idle_.notify_one();
+            }
+        }
+
+        size_t submitting_node() const
+        {
+            if (node_workers_.size() == 1) // unpinned or a single node - no sched_getcpu() on the submit path
+                return 0;
+
+            const int cpu = current_cpu();
+            if (cpu < 0 || static_cast<size_t>(cpu) >= cpu_nodes_.size())
+                return 0;
+            return cpu_nodes_[cpu];
+        }
+
+        std::vector<size_t> steal_order(size_t index) const
+        {
+            std::vector<size_t> victims;
+            victims.reserve(size_ - 1);
+
+            for (size_t i = 1; i < size_; ++i)
+                if (workers_[(index + i) % size_].node == workers_[index].node)
+                    victims.push_back((index + i) % size_);
+
+            for (size_t i = 1; i < size_; ++i)
+                if (workers_[(index + i) % size_].node != workers_[index].node)
+                    victims.push_back((index + i) % size_);
+
+            return victims;
+        }
+
+        bool try_get_task(size_t index, Task& task)
+        {
+            if (workers_[index].tasks.try_pop(task))
+                return true;
+
+            for (size_t victim : workers_[index].victims)
+            {
+                if (workers_[victim].tasks.try_steal(task))
+                    return true;
+            }
+
+            // a steal may have failed only because a victim held its lock - with pending_tasks_ > 0 the worker
+            // would not go idle, so it waits for the locks instead of spinning through try_steal again
+            if (pending_tasks_.load() > 0)
+            {
+                for (size_t victim : workers_[index].victims)
+                {
+                    if (workers_[victim].tasks.steal(task))
+                        return true;
+                }
+            }
+
+            return false;
+        }
+
+        void run(size_t index)
+        {
+            this_pool_ = this;
+            this_worker_index_ = index;
+
+            Task task;
+            while (true)
+            {
+                if (try_get_task(index, task))
+                {
+                    pending_tasks_.fetch_sub(1);
+                    task(); // running task in this thread
+                    task = nullptr;
+                    continue;
+                }
+
+                std::unique_lock lk{mtx_idle_};
+                idle_workers_.fetch_add(1);
+                cv_idle_.wait(lk, [this] { return pending_tasks_.load() > 0 || is_done_; });
+                idle_workers_.fetch_sub(1);
+
+                if (is_done_ && pending_tasks_.load() == 0)
+                    return;
+            }
+        }
+    };
+} // namespace WorkStealing
+
+#endif // WORK_STEALING_THREAD_POOL_HPP